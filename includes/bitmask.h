@@ -0,0 +1,58 @@
+/* bitmask.h */
+
+#ifndef BITMASK_H
+#define BITMASK_H
+
+#include "libs.h"
+#include "vector.h"
+
+/* One bit per element, 64 elements per word, element i is bit i % 64 of
+   words[i / 64]. Bits past size in the last word are always zero, so
+   popcount and the word-wise algebra never need a tail fix-up. */
+struct BitMask{
+	size_t size;
+	uint64_t *words;
+};
+
+#define MASK_WORDS(n) (((n) + 63) / 64)
+
+/* Creation / destruction */
+struct BitMask *mask_alloc(size_t size);
+struct BitMask *mask_zeros(size_t size);
+void dest_mask(struct BitMask *mask);
+
+/* Element access */
+int mask_get(const struct BitMask *mask, size_t i);
+void mask_set(struct BitMask *mask, size_t i, int value);
+
+/* Conversion to and from 0.0 / 1.0 vectors (nonzero counts as set) */
+struct BitMask *mask_from_vec(const struct Vector *v);
+struct Vector *vec_from_mask(const struct BitMask *mask);
+
+/* Mask algebra, dst may alias either input */
+int mask_and(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b);
+int mask_or(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b);
+int mask_xor(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b);
+int mask_not(struct BitMask *dst, const struct BitMask *a);
+size_t mask_popcount(const struct BitMask *mask);
+
+/* Comparisons producing bitmasks */
+struct BitMask *vec_gt_mask(const struct Vector *a, const struct Vector *b);
+struct BitMask *vec_lt_mask(const struct Vector *a, const struct Vector *b);
+struct BitMask *vec_eq_mask(const struct Vector *a, const struct Vector *b);
+struct BitMask *vec_gt_scalar_mask(const struct Vector *v, double s);
+struct BitMask *vec_lt_scalar_mask(const struct Vector *v, double s);
+struct BitMask *vec_eq_scalar_mask(const struct Vector *v, double s);
+
+int vec_gt_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b);
+int vec_lt_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b);
+int vec_eq_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b);
+int vec_gt_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s);
+int vec_lt_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s);
+int vec_eq_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s);
+
+/* Selection driven by a bitmask */
+struct Vector *vec_where_mask(const struct BitMask *mask, const struct Vector *a, const struct Vector *b);
+struct Vector *vec_filter_mask(const struct Vector *v, const struct BitMask *mask);
+
+#endif
@@ -0,0 +1,73 @@
+/* expr.h */
+
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "libs.h"
+#include "vector.h"
+
+/* Deferred elementwise expressions.
+
+   Builders record a node and return at once; nothing is computed until
+   vec_eval, which walks the whole expression in one pass over blocks of a
+   few hundred elements, so intermediates live in cache-sized scratch and
+   never as full temporaries:
+
+       struct VecGraph *g = vec_graph_create();
+       struct VecExpr *x = vec_expr_vec(g, v);
+       struct VecExpr *e = vec_expr_exp(vec_expr_mul_scalar(vec_expr_sub_scalar(x, mu), k));
+       struct Vector *out = vec_eval(e);
+       vec_graph_destroy(g);
+
+   Nodes belong to their graph and are freed with it; a node may feed any
+   number of later nodes. Leaf vectors are borrowed and must outlive the
+   evaluation. A builder given a NULL operand returns NULL without printing
+   anything, so a chain needs only one check, at vec_eval. */
+
+struct VecGraph;
+struct VecExpr;
+
+struct VecGraph *vec_graph_create(void);
+void vec_graph_destroy(struct VecGraph *graph);
+
+/* Leaf */
+struct VecExpr *vec_expr_vec(struct VecGraph *graph, const struct Vector *v);
+
+/* Elementwise arithmetic */
+struct VecExpr *vec_expr_add(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_sub(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_mul(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_div(struct VecExpr *a, struct VecExpr *b);
+
+struct VecExpr *vec_expr_add_scalar(struct VecExpr *e, double s);
+struct VecExpr *vec_expr_sub_scalar(struct VecExpr *e, double s);
+struct VecExpr *vec_expr_mul_scalar(struct VecExpr *e, double s);
+struct VecExpr *vec_expr_div_scalar(struct VecExpr *e, double s);
+
+/* Comparisons (1.0 / 0.0, same tolerance as vec_eq) */
+struct VecExpr *vec_expr_gt(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_lt(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_eq(struct VecExpr *a, struct VecExpr *b);
+struct VecExpr *vec_expr_gt_scalar(struct VecExpr *e, double s);
+struct VecExpr *vec_expr_lt_scalar(struct VecExpr *e, double s);
+struct VecExpr *vec_expr_eq_scalar(struct VecExpr *e, double s);
+
+/* Math, same kernels as vec_math_* */
+struct VecExpr *vec_expr_exp(struct VecExpr *e);
+struct VecExpr *vec_expr_loge(struct VecExpr *e);
+struct VecExpr *vec_expr_sqrt(struct VecExpr *e);
+struct VecExpr *vec_expr_pow(struct VecExpr *e, double power);
+struct VecExpr *vec_expr_sin(struct VecExpr *e);
+struct VecExpr *vec_expr_cos(struct VecExpr *e);
+struct VecExpr *vec_expr_tan(struct VecExpr *e);
+struct VecExpr *vec_expr_sinh(struct VecExpr *e);
+struct VecExpr *vec_expr_cosh(struct VecExpr *e);
+struct VecExpr *vec_expr_tanh(struct VecExpr *e);
+struct VecExpr *vec_expr_abs(struct VecExpr *e);
+
+/* Evaluation; dst may be one of the leaf vectors */
+size_t vec_expr_size(const struct VecExpr *e);
+struct Vector *vec_eval(const struct VecExpr *e);
+int vec_eval_into(struct Vector *dst, const struct VecExpr *e);
+
+#endif
@@ -0,0 +1,165 @@
+/* fvector.h */
+
+#ifndef FVECTOR_H
+#define FVECTOR_H
+
+#include "libs.h"
+#include "vector.h"
+
+/* Single-precision twin of struct Vector: half the memory traffic and twice
+   the SIMD width, backed by the cblas_s* routines. Buffers have the same
+   VEC_ALIGNMENT guarantee and fvec_alloc honours vec_arena_use. Sums and
+   other accumulations run in double and are returned as double. */
+struct FVector{
+	size_t size;
+	float *data;
+	unsigned int storage;   /* VEC_STORAGE_HEAP or VEC_STORAGE_ARENA */
+};
+
+/* FVECTOR CREATION FUNCTIONS */
+struct FVector *fvec_alloc(size_t size);
+struct FVector *fvec_zeros(size_t size);
+struct FVector *fvec_ones(size_t size);
+struct FVector *fvec_scalar(size_t size, float scalar);
+struct FVector *fvec_arange(size_t size, float start, float step);
+struct FVector *fvec_linspace(size_t size, float start, float end);
+struct FVector *fvec_from_array(const float *arr, size_t size);
+
+/* Destruction / print */
+void dest_fvector(struct FVector *vector);
+void print_fvector(const struct FVector *vector);
+
+/* Precision conversion */
+struct FVector *fvec_from_vec(const struct Vector *v);
+struct Vector *vec_from_fvec(const struct FVector *v);
+int fvec_from_vec_into(struct FVector *dst, const struct Vector *src);
+int vec_from_fvec_into(struct Vector *dst, const struct FVector *src);
+
+/* Aggregation */
+double fvec_aggr_sum(const struct FVector *vector);
+double fvec_aggr_mean(const struct FVector *vector);
+float fvec_aggr_min(const struct FVector *vector);
+float fvec_aggr_max(const struct FVector *vector);
+int fvec_aggr_argmin(const struct FVector *vector);
+int fvec_aggr_argmax(const struct FVector *vector);
+
+/* math Functions (Out Of Place) */
+struct FVector *fvec_math_pow(const struct FVector *vector, float power);
+struct FVector *fvec_math_sqrt(const struct FVector *vector);
+struct FVector *fvec_math_cbrt(const struct FVector *vector);
+struct FVector *fvec_math_sin(const struct FVector *vector);
+struct FVector *fvec_math_cos(const struct FVector *vector);
+struct FVector *fvec_math_tan(const struct FVector *vector);
+struct FVector *fvec_math_asin(const struct FVector *vector);
+struct FVector *fvec_math_acos(const struct FVector *vector);
+struct FVector *fvec_math_atan(const struct FVector *vector);
+struct FVector *fvec_math_sinh(const struct FVector *vector);
+struct FVector *fvec_math_cosh(const struct FVector *vector);
+struct FVector *fvec_math_tanh(const struct FVector *vector);
+struct FVector *fvec_math_loge(const struct FVector *vector);
+struct FVector *fvec_math_log(const struct FVector *vector, float base);
+struct FVector *fvec_math_exp(const struct FVector *vector);
+struct FVector *fvec_math_floor(const struct FVector *vector);
+struct FVector *fvec_math_ceil(const struct FVector *vector);
+struct FVector *fvec_math_fmod(const struct FVector *vector, float divisor);
+struct FVector *fvec_math_trunc(const struct FVector *vector);
+struct FVector *fvec_math_round(const struct FVector *vector);
+
+/* math Functions (caller-provided output, dst may alias vector) */
+int fvec_math_pow_into(struct FVector *dst, const struct FVector *vector, float power);
+int fvec_math_sqrt_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_cbrt_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_sin_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_cos_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_tan_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_asin_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_acos_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_atan_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_sinh_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_cosh_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_tanh_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_loge_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_log_into(struct FVector *dst, const struct FVector *vector, float base);
+int fvec_math_exp_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_floor_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_ceil_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_fmod_into(struct FVector *dst, const struct FVector *vector, float divisor);
+int fvec_math_trunc_into(struct FVector *dst, const struct FVector *vector);
+int fvec_math_round_into(struct FVector *dst, const struct FVector *vector);
+
+/* math Functions (inplace) */
+int fvec_math_pow_inplace(struct FVector *vector, float power);
+int fvec_math_sqrt_inplace(struct FVector *vector);
+int fvec_math_cbrt_inplace(struct FVector *vector);
+int fvec_math_sin_inplace(struct FVector *vector);
+int fvec_math_cos_inplace(struct FVector *vector);
+int fvec_math_tan_inplace(struct FVector *vector);
+int fvec_math_asin_inplace(struct FVector *vector);
+int fvec_math_acos_inplace(struct FVector *vector);
+int fvec_math_atan_inplace(struct FVector *vector);
+int fvec_math_sinh_inplace(struct FVector *vector);
+int fvec_math_cosh_inplace(struct FVector *vector);
+int fvec_math_tanh_inplace(struct FVector *vector);
+int fvec_math_loge_inplace(struct FVector *vector);
+int fvec_math_log_inplace(struct FVector *vector, float base);
+int fvec_math_exp_inplace(struct FVector *vector);
+int fvec_math_floor_inplace(struct FVector *vector);
+int fvec_math_ceil_inplace(struct FVector *vector);
+int fvec_math_fmod_inplace(struct FVector *vector, float divisor);
+int fvec_math_trunc_inplace(struct FVector *vector);
+int fvec_math_round_inplace(struct FVector *vector);
+
+/* Arithmetic */
+struct FVector *fvec_add(const struct FVector *a, const struct FVector *b);
+struct FVector *fvec_sub(const struct FVector *a, const struct FVector *b);
+struct FVector *fvec_mul(const struct FVector *a, const struct FVector *b);
+int fvec_add_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_sub_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_mul_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_mul_inplace(struct FVector *a, const struct FVector *b);
+
+/* Scalar Functions */
+struct FVector *fvec_add_scalar(const struct FVector *v, float s);
+struct FVector *fvec_sub_scalar(const struct FVector *v, float s);
+struct FVector *fvec_mul_scalar(const struct FVector *v, float s);
+struct FVector *fvec_div_scalar(const struct FVector *v, float s);
+int fvec_add_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_sub_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_mul_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_div_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_add_scalar_inplace(struct FVector *v, float s);
+int fvec_sub_scalar_inplace(struct FVector *v, float s);
+int fvec_mul_scalar_inplace(struct FVector *v, float s);
+int fvec_div_scalar_inplace(struct FVector *v, float s);
+
+/* BLAS Level-1 (cblas_s*) */
+float fvec_dot(const struct FVector *a, const struct FVector *b);
+int fvec_copy(struct FVector *dest, const struct FVector *src);
+int fvec_scale_inplace(struct FVector *v, float scalar);
+int fvec_axpy_inplace(struct FVector *y, const struct FVector *x, float a);
+float fvec_norm2(const struct FVector *v);
+float fvec_asum(const struct FVector *v);
+int fvec_iamax(const struct FVector *v);
+
+/* Statistical functions (population statistics, double accumulation) */
+double fvec_var(const struct FVector *v);
+double fvec_std(const struct FVector *v);
+double fvec_sum_of_squares(const struct FVector *v);
+double fvec_cov(const struct FVector *a, const struct FVector *b);
+double fvec_corr(const struct FVector *a, const struct FVector *b);
+
+/* Comparison Functions (1.0f / 0.0f results) */
+struct FVector *fvec_gt(const struct FVector *a, const struct FVector *b);
+struct FVector *fvec_lt(const struct FVector *a, const struct FVector *b);
+struct FVector *fvec_eq(const struct FVector *a, const struct FVector *b);
+struct FVector *fvec_gt_scalar(const struct FVector *v, float s);
+struct FVector *fvec_lt_scalar(const struct FVector *v, float s);
+struct FVector *fvec_eq_scalar(const struct FVector *v, float s);
+int fvec_gt_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_lt_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_eq_into(struct FVector *dst, const struct FVector *a, const struct FVector *b);
+int fvec_gt_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_lt_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+int fvec_eq_scalar_into(struct FVector *dst, const struct FVector *v, float s);
+
+#endif
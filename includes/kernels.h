@@ -0,0 +1,115 @@
+/* kernels.h */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "libs.h"
+
+/* Tolerance of vec_eq and friends */
+#define VEC_EQ_EPS 1e-12
+
+struct VecMoments;
+
+/* Partial statistics of one block, NaN elements skipped. m2 is the sum of
+   squared deviations from the block's own mean. argmin / argmax are
+   block-relative and SIZE_MAX when nothing is below +inf / above -inf
+   (every element NaN or equal to that infinity). */
+struct VecBlockStats{
+	size_t count;
+	double sum;
+	double m2;
+	double min, max;
+	size_t argmin, argmax;
+	double l1;
+	double l2sq;
+};
+
+/* One implementation of every dispatched hot loop. All pointers are raw
+   arrays of n doubles; dst may equal an input but must not otherwise
+   overlap it. Comparisons store 1.0 / 0.0. min / max skip NaN and start
+   from DBL_MAX / -DBL_MAX like the scalar code always has. Reductions
+   split the sum over several accumulators, so the last bits may differ
+   between levels. */
+struct VecKernels{
+	int isa;
+
+	void (*add)(double *dst, const double *a, const double *b, size_t n);
+	void (*sub)(double *dst, const double *a, const double *b, size_t n);
+	void (*mul)(double *dst, const double *a, const double *b, size_t n);
+
+	void (*add_scalar)(double *dst, const double *x, double s, size_t n);
+	void (*sub_scalar)(double *dst, const double *x, double s, size_t n);
+	void (*mul_scalar)(double *dst, const double *x, double s, size_t n);
+	void (*div_scalar)(double *dst, const double *x, double s, size_t n);
+
+	void (*gt)(double *dst, const double *a, const double *b, size_t n);
+	void (*lt)(double *dst, const double *a, const double *b, size_t n);
+	void (*eq)(double *dst, const double *a, const double *b, size_t n);
+	void (*gt_scalar)(double *dst, const double *x, double s, size_t n);
+	void (*lt_scalar)(double *dst, const double *x, double s, size_t n);
+	void (*eq_scalar)(double *dst, const double *x, double s, size_t n);
+
+	double (*sum)(const double *x, size_t n);
+	double (*sum_sq)(const double *x, size_t n);
+	double (*min)(const double *x, size_t n);
+	double (*max)(const double *x, size_t n);
+	double (*sum_kahan)(const double *x, size_t n);
+
+	void (*describe)(const double *x, size_t n, struct VecBlockStats *out);
+	void (*moments)(const double *a, const double *b, size_t n, struct VecMoments *out);
+
+	size_t (*find_above)(const double *x, size_t n, double t);
+	size_t (*find_below)(const double *x, size_t n, double t);
+
+	void (*where)(double *dst, const double *mask, const double *a, const double *b, size_t n);
+	size_t (*count_nonzero)(const double *mask, size_t n);
+	size_t (*compress)(double *dst, const double *x, const double *mask, size_t n, size_t cap);
+
+	/* vmath.h kernels, y[i] = f(x[i]) */
+	void (*exp)(double *y, const double *x, size_t n);
+	void (*log)(double *y, const double *x, size_t n);
+	void (*sin)(double *y, const double *x, size_t n);
+	void (*cos)(double *y, const double *x, size_t n);
+	void (*tan)(double *y, const double *x, size_t n);
+	void (*sinh)(double *y, const double *x, size_t n);
+	void (*cosh)(double *y, const double *x, size_t n);
+	void (*tanh)(double *y, const double *x, size_t n);
+	void (*sqrt)(double *y, const double *x, size_t n);
+};
+
+/* One Neumaier step: add x into the running (sum, comp) pair, keeping the
+   low bits lost by the addition in comp */
+static inline void vec_neumaier_add(double *sum, double *comp, double x)
+{
+	double t = *sum + x;
+	if (fabs(*sum) >= fabs(x)) *comp += (*sum - t) + x;
+	else                       *comp += (x - t) + *sum;
+	*sum = t;
+}
+
+/* Whole-array sum under one VEC_SUM_* mode */
+double vec_sum_array(const double *x, size_t n, int mode);
+
+/* Worker threads for the _parallel entry points. vec_parallel_threads
+   turns a request (0: every online CPU) into a count that leaves each
+   thread at least VEC_PARALLEL_MIN_CHUNK elements of n. vec_run_parallel
+   calls fn on each of count argument blocks of arg_size bytes, block 0
+   on the calling thread, and returns when all are done. */
+#define VEC_MAX_THREADS 256
+#define VEC_PARALLEL_MIN_CHUNK ((size_t)1 << 16)
+
+int vec_parallel_threads(int nthreads, size_t n);
+void vec_run_parallel(void *(*fn)(void *), void *args, size_t arg_size, int count);
+
+/* Table for the active level, resolved on first call */
+const struct VecKernels *vec_kernels(void);
+
+/* Per-level tables, defined in kernels_<isa>.c */
+extern const struct VecKernels vec_kernels_scalar;
+#if defined(__x86_64__) || defined(__i386__)
+extern const struct VecKernels vec_kernels_sse2;
+extern const struct VecKernels vec_kernels_avx2;
+extern const struct VecKernels vec_kernels_avx512;
+#endif
+
+#endif
@@ -12,6 +12,7 @@
 #include <stdbool.h>
 #include <time.h>
 #include <errno.h>
+#include <string.h>
 
 
 #include <openblas/cblas.h>
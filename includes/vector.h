@@ -5,13 +5,251 @@
 
 #include "libs.h"
 
+/* Every data buffer handed out by this library starts on a cache line,
+   which is also the width of one AVX-512 register. */
+#define VEC_ALIGNMENT 64
+
+/* Buffers of at least this many bytes are backed by transparent huge pages
+   when enabled with vec_set_hugepages(1) or AXPY_HUGEPAGES=1 (Linux only). */
+#define VEC_HUGEPAGE_SIZE      ((size_t)2 * 1024 * 1024)
+#define VEC_HUGEPAGE_THRESHOLD VEC_HUGEPAGE_SIZE
+
+/* Who owns a vector's memory, kept in Vector.storage. Zero is the classic
+   layout, so zero-initialised vectors keep working with dest_vector; code
+   that builds a struct Vector itself (malloc, not calloc) must set
+   storage = VEC_STORAGE_HEAP. dest_vector refuses any other tag. */
+#define VEC_STORAGE_HEAP  0u   /* struct and data allocated separately */
+#define VEC_STORAGE_ARENA 1u   /* bump-allocated, released by vec_arena_reset */
+#define VEC_STORAGE_INLINE 2u  /* header and payload in one block, see below */
+#define VEC_STORAGE_MMAP  3u   /* file mapping, released by vec_mmap_close */
+
+/* Instruction-set levels for the dispatched kernels, ordered so a higher
+   level implies the lower ones. Picked at first use from the CPU, or from
+   AXPY_ISA=scalar|sse2|avx2|avx512, and changeable with vec_set_isa. */
+#define VEC_ISA_SCALAR 0
+#define VEC_ISA_SSE2   1
+#define VEC_ISA_AVX2   2
+#define VEC_ISA_AVX512 3
+
+/* Summation algorithms behind vec_aggr_sum, vec_aggr_mean and, through
+   vec_moments_update, vec_var, vec_cov and vec_corr. FAST splits the sum over SIMD accumulators;
+   PAIRWISE adds fixed-size leaves in a balanced tree, error growing with
+   log n; KAHAN is Neumaier-compensated, error independent of n, at about
+   half the speed of FAST. The policy is process-wide and starts at FAST. */
+#define VEC_SUM_FAST     0
+#define VEC_SUM_PAIRWISE 1
+#define VEC_SUM_KAHAN    2
+
+/* vec_percentiles methods, h = p / 100 * (n - 1) for all but RANK:
+   RANK is nearest rank like vec_percentile, LINEAR interpolates between
+   floor(h) and ceil(h) (the usual default elsewhere), LOWER / HIGHER take
+   one of the two and MIDPOINT averages them. */
+#define VEC_PCT_RANK     0
+#define VEC_PCT_LINEAR   1
+#define VEC_PCT_LOWER    2
+#define VEC_PCT_HIGHER   3
+#define VEC_PCT_MIDPOINT 4
+
+/* vec_mmap_open modes: one access mode, optionally OR'ed with one hint */
+#define VEC_MMAP_RDONLY     0x00  /* read-only; writing through data faults */
+#define VEC_MMAP_RDWR       0x01  /* shared, writes reach the file */
+#define VEC_MMAP_PRIVATE    0x02  /* writable copy-on-write, file untouched */
+#define VEC_MMAP_SEQUENTIAL 0x10  /* madvise: streaming reads, aggressive readahead */
+#define VEC_MMAP_RANDOM     0x20  /* madvise: no readahead */
+#define VEC_MMAP_WILLNEED   0x40  /* madvise: start paging everything in now */
+
 struct Vector{
 	size_t size;
 	double *data;
+	unsigned int storage;
+};
+
+/* Single-allocation layout: the header is followed by its own payload on
+   the next cache line and data points at payload, so code that only
+   touches size/data cannot tell it from a classic vector. */
+struct VectorInline{
+	struct Vector vec;
+	_Alignas(VEC_ALIGNMENT) double payload[];
+};
+
+/* Non-owning window onto doubles: element i lives at data[i * stride].
+   Strides go straight through to CBLAS, so a column of a row-major matrix
+   or every k-th element of a vector needs no copy. stride must be >= 1. */
+struct VectorView{
+	double *data;
+	size_t size;
+	size_t stride;
+};
+
+/* On-disk vector format, version 1. A 64-byte native-endian header is
+   followed by the payload at data_offset, which is a multiple of
+   VEC_ALIGNMENT, so vec_load can map the payload in place. */
+#define VEC_FILE_VERSION     1u
+#define VEC_FILE_HEADER_SIZE 64u
+
+#define VEC_DTYPE_F64 1u
+#define VEC_DTYPE_F32 2u
+
+#define VEC_FILE_HAS_CHECKSUM 0x1u   /* VecFileHeader.flags */
+
+struct VecFileHeader{
+	char     magic[8];      /* "AXPYVEC\0" */
+	uint32_t version;
+	uint32_t dtype;         /* VEC_DTYPE_* */
+	uint64_t count;         /* number of elements */
+	uint64_t data_offset;   /* payload start in bytes from file start */
+	uint32_t alignment;     /* alignment data_offset was padded to */
+	uint32_t flags;         /* VEC_FILE_* */
+	uint64_t checksum;      /* vec_checksum of the payload, if flagged */
+	uint32_t byte_order;    /* 0x01020304 as written by the saving host */
+	uint8_t  reserved[12];
+};
+
+/* vec_save flags */
+#define VEC_SAVE_CHECKSUM 0x1
+
+/* vec_load modes, OR'ed with the VEC_MMAP_* access mode and hint */
+#define VEC_LOAD_VERIFY 0x100   /* check the payload checksum (reads every page); EINVAL if none was saved */
+#define VEC_LOAD_COPY   0x200   /* read into a heap vector instead of mapping */
+
+/* Chunked input for the streaming reductions. next fills up to cap doubles
+   into buf and returns how many it wrote: 0 at end of stream,
+   VEC_CHUNK_ERROR (with errno set) on failure. A source whose data is
+   already in memory may also set window, which returns a pointer to the
+   next up to cap doubles in place and stores their count in *got (0 at
+   end); the reductions then read straight from it, with no copy and no
+   helper thread. Leaving window NULL (as { next, ctx } does) is fine. */
+#define VEC_CHUNK_ERROR ((size_t)-1)
+
+typedef size_t (*vec_chunk_fn)(void *ctx, double *buf, size_t cap);
+typedef const double *(*vec_window_fn)(void *ctx, size_t cap, size_t *got);
+
+struct VecChunkSource{
+	vec_chunk_fn next;
+	void *ctx;
+	vec_window_fn window;
+};
+
+/* state for vec_source_vector, owned by the caller */
+struct VecVectorCursor{
+	const struct Vector *v;
+	size_t pos;
+};
+
+/* Result of vec_stream_stats; var is the population variance like vec_var */
+struct VecStreamStats{
+	size_t count;
+	double sum;
+	double mean;
+	double var;
+	double min;
+	double max;
+	double norm2;
+};
+
+/* Result of vec_describe. NaN elements are counted in nan_count and left
+   out of everything else; var is the population variance like vec_var.
+   argmin / argmax are the first index of min / max. With no non-NaN
+   element mean, var, min and max are NaN and the indices SIZE_MAX. */
+struct VecStats{
+	size_t count;
+	size_t nan_count;
+	double sum;
+	double mean;
+	double var;
+	double min;
+	double max;
+	size_t argmin;
+	size_t argmax;
+	double norm1;
+	double norm2;
 };
 
+/* Mergeable partial state of var / cov / corr: the count, the means and
+   the centred sums of squares and cross-products (Chan et al.). Chunks or
+   threads each fill their own with vec_moments_update and combine them
+   with vec_moments_merge; the order of merging does not matter beyond
+   rounding. Zero-initialised (or vec_moments_init) means empty. */
+struct VecMoments{
+	size_t count;
+	double mean_a, mean_b;
+	double m2_a, m2_b;
+	double c_ab;
+};
+
+/* Bump allocator for short-lived vectors */
+struct VecArena;
+
+/* Aligned storage */
+size_t vec_alignment(void);
+int vec_is_aligned(const struct Vector *v);
+void vec_set_hugepages(int enable);
+int vec_get_hugepages(void);
+void *vec_aligned_alloc(size_t bytes);
+void vec_aligned_free(void *ptr);
+
+/* CPU dispatch
+   vec_set_isa forces a level (for benchmarks and tests); it fails with
+   ENOTSUP when the CPU lacks it. Not meant to be called while other
+   threads are running kernels. */
+int vec_cpu_isa(void);
+int vec_get_isa(void);
+int vec_set_isa(int isa);
+const char *vec_isa_name(int isa);
+
+/* Summation policy
+   vec_set_sum_mode fails with EINVAL on an unknown mode. Like vec_set_isa,
+   set it before other threads start summing. */
+int vec_get_sum_mode(void);
+int vec_set_sum_mode(int mode);
+
+/* Arena allocation
+   While an arena is installed with vec_arena_use, every creation and
+   out-of-place function on this thread allocates from it. dest_vector is a
+   no-op on such vectors; vec_arena_reset releases all of them at once. */
+struct VecArena *vec_arena_create(size_t capacity);
+void vec_arena_reset(struct VecArena *arena);
+void vec_arena_destroy(struct VecArena *arena);
+struct VecArena *vec_arena_use(struct VecArena *arena);
+struct VecArena *vec_arena_current(void);
+void *vec_arena_alloc_bytes(struct VecArena *arena, size_t bytes);
+struct Vector *vec_arena_alloc(struct VecArena *arena, size_t size);
+
+/* Memory-mapped vectors
+   data points straight into the file (native-endian doubles), pages are
+   read lazily on first touch. dest_vector on such a vector unmaps it. */
+struct Vector *vec_mmap_open(const char *path, int mode);
+struct Vector *vec_mmap_open_range(const char *path, int mode, size_t offset, size_t count);
+int vec_mmap_advise(struct Vector *v, int mode);
+int vec_mmap_sync(struct Vector *v);
+int vec_mmap_close(struct Vector *v);
+
+/* Binary persistence */
+int vec_save(const struct Vector *v, const char *path, int flags);
+struct Vector *vec_load(const char *path, int mode);
+int vec_read_header(const char *path, struct VecFileHeader *hdr);
+uint64_t vec_checksum(const void *data, size_t bytes);
+
+/* Streaming (out-of-core) reductions
+   One bounded-memory pass over a chunk source: two chunk buffers, the next
+   one filled by a helper thread (one per pass) while the current one is
+   reduced. vec_source_vector reads the vector in place instead; for a
+   mapped vector, open it with VEC_MMAP_SEQUENTIAL so the kernel reads
+   ahead. chunk is in elements, at most INT_MAX (EINVAL beyond), 0 picks
+   a default of 1M. */
+struct VecChunkSource vec_source_file(FILE *f);
+#if !defined(_WIN32)
+struct VecChunkSource vec_source_fd(int fd);
+#endif
+struct VecChunkSource vec_source_vector(struct VecVectorCursor *cursor, const struct Vector *v);
+int vec_stream_stats(struct VecChunkSource src, size_t chunk, struct VecStreamStats *out);
+int vec_stream_dot(struct VecChunkSource a, struct VecChunkSource b, size_t chunk, double *out);
+
 /* VECTOR CREATION FUNCTIONS*/
 struct Vector *vec_alloc(size_t size);
+struct Vector *vec_alloc_inline(size_t size);
+void vec_set_inline_threshold(size_t size);
+size_t vec_get_inline_threshold(void);
 struct Vector *vec_zeros(size_t size);
 struct Vector *vec_ones(size_t size);
 struct Vector *vec_scalar(size_t size, double scalar);
@@ -28,6 +266,7 @@ void print_vector(const struct Vector *vector);
 
 /* VECTOR AGGREGATION FUNCTION*/
 double vec_aggr_sum(const struct Vector *vector);
+double vec_aggr_sum_mode(const struct Vector *vector, int mode);
 double vec_aggr_mean(const struct Vector *vector);
 double vec_aggr_min(const struct Vector *vector);
 double vec_aggr_max(const struct Vector *vector);
@@ -81,6 +320,47 @@ int vec_math_trunc_inplace(struct Vector *vector);
 int vec_math_round_inplace(struct Vector *vector);
 
 
+/* Caller-provided output ("_into")
+   Same operations as the out-of-place functions, written into an existing
+   vector of matching size without allocating. dst may be the very same
+   vector as any input (dst == a updates a in place); partially overlapping
+   buffers are not supported. Return 0 on success, -1 with errno set. */
+int vec_math_pow_into(struct Vector *dst, const struct Vector *vector, double power);
+int vec_math_sqrt_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_cbrt_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_sin_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_cos_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_tan_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_asin_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_acos_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_atan_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_sinh_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_cosh_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_tanh_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_loge_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_log_into(struct Vector *dst, const struct Vector *vector, double base);
+int vec_math_exp_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_floor_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_ceil_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_fmod_into(struct Vector *dst, const struct Vector *vector, double divisor);
+int vec_math_trunc_into(struct Vector *dst, const struct Vector *vector);
+int vec_math_round_into(struct Vector *dst, const struct Vector *vector);
+
+int vec_add_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_sub_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_mul_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_add_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_sub_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_mul_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_div_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_gt_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_lt_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_eq_into(struct Vector *dst, const struct Vector *a, const struct Vector *b);
+int vec_gt_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_lt_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+int vec_eq_scalar_into(struct Vector *dst, const struct Vector *v, double s);
+
+
 /* Arithmetic Functions (BLAS) */
 struct Vector *vec_add(const struct Vector *a, const struct Vector *b);
 struct Vector *vec_sub(const struct Vector *a, const struct Vector *b);
@@ -112,6 +392,31 @@ double vec_asum(const struct Vector *v);
 int vec_iamax(const struct Vector *v);
 
 
+/* Strided views (non-owning, nothing to free)
+   The Level-1 wrappers above are thin shims over these. An invalid view
+   has data == NULL and is rejected by every function below. */
+struct VectorView vec_view(const struct Vector *v);
+struct VectorView vec_view_strided(double *data, size_t size, size_t stride);
+struct VectorView vec_view_slice(const struct Vector *v, size_t start, size_t count, size_t step);
+struct VectorView vec_view_column(double *matrix, size_t rows, size_t cols, size_t col);
+
+double vec_view_dot(struct VectorView a, struct VectorView b);
+int vec_view_copy(struct VectorView dest, struct VectorView src);
+int vec_view_scale(struct VectorView v, double scalar);
+int vec_view_axpy(struct VectorView y, struct VectorView x, double a);
+double vec_view_norm2(struct VectorView v);
+double vec_view_asum(struct VectorView v);
+int vec_view_iamax(struct VectorView v);
+
+int vec_view_add(struct VectorView dst, struct VectorView a, struct VectorView b);
+int vec_view_sub(struct VectorView dst, struct VectorView a, struct VectorView b);
+int vec_view_mul(struct VectorView dst, struct VectorView a, struct VectorView b);
+int vec_view_add_scalar(struct VectorView dst, struct VectorView v, double s);
+int vec_view_sub_scalar(struct VectorView dst, struct VectorView v, double s);
+int vec_view_mul_scalar(struct VectorView dst, struct VectorView v, double s);
+int vec_view_div_scalar(struct VectorView dst, struct VectorView v, double s);
+
+
 /* Statistical functions */
 double vec_var(const struct Vector *v);
 double vec_std(const struct Vector *v);
@@ -121,6 +426,34 @@ double vec_sum_of_squares(const struct Vector *v);
 double vec_cov(const struct Vector *a, const struct Vector *b);
 double vec_corr(const struct Vector *a, const struct Vector *b);
 
+/* Order statistics by selection, O(n) expected. The plain forms work on a
+   copy; the _inplace forms reorder v instead. NaNs rank above +inf, so a
+   rank that lands on one gives NaN. vec_percentile uses nearest rank and
+   vec_kth counts k from 0. */
+double vec_median_inplace(struct Vector *v);
+double vec_percentile_inplace(struct Vector *v, double p);
+double vec_kth_inplace(struct Vector *v, size_t k);
+
+/* k percentiles (0..100) of one copy into out[0..k), in the order given,
+   at roughly the cost of a single selection; returns 0 or -1 */
+int vec_percentiles(const struct Vector *v, const double *ps, size_t k, double *out, int method);
+int vec_percentiles_inplace(struct Vector *v, const double *ps, size_t k, double *out, int method);
+
+/* One-pass summary: every field of struct VecStats in a single sweep */
+int vec_describe(const struct Vector *v, struct VecStats *out);
+
+/* Single-pass moments; b may be NULL when only a's variance is wanted.
+   vec_moments_update merges its per-block moments under the VEC_SUM_*
+   policy (in order, as a balanced tree, or compensated), and vec_var,
+   vec_cov and vec_corr go through it. The results are population statistics like vec_var and are NaN for an
+   empty state (corr also when either variance is zero). */
+void vec_moments_init(struct VecMoments *m);
+int vec_moments_update(struct VecMoments *m, const struct Vector *a, const struct Vector *b);
+void vec_moments_merge(struct VecMoments *dst, const struct VecMoments *src);
+double vec_moments_var(const struct VecMoments *m);
+double vec_moments_cov(const struct VecMoments *m);
+double vec_moments_corr(const struct VecMoments *m);
+
 /* Comparison Functions */
 struct Vector *vec_gt(const struct Vector *a, const struct Vector *b);
 struct Vector *vec_lt(const struct Vector *a, const struct Vector *b);
@@ -130,20 +463,98 @@ struct Vector *vec_gt_scalar(const struct Vector *v, double s);
 struct Vector *vec_lt_scalar(const struct Vector *v, double s);
 struct Vector *vec_eq_scalar(const struct Vector *v, double s);
 
-/* Mask / selection operations */
+/* Mask / selection operations
+   A mask element selects when nonzero (NaN included). vec_filter packs
+   the selected elements of v, in order, into a new vector; the _parallel
+   form splits the work over nthreads (0: every online CPU) with the same
+   result. */
 struct Vector *vec_where(const struct Vector *mask, const struct Vector *a, const struct Vector *b);
 struct Vector *vec_filter(const struct Vector *v, const struct Vector *mask);
+struct Vector *vec_filter_parallel(const struct Vector *v, const struct Vector *mask, int nthreads);
 
 
-/* sorting/ranking */
+/* sorting/ranking
+   vec_sort orders v ascending in place, vec_argsort fills indices[0..size)
+   with the permutation that would (stable: ties keep their order). Both
+   radix-sort an order-preserving integer key, O(n); NaNs go last and
+   -0 before +0. */
 int vec_sort(struct Vector *v);
 int vec_argsort(const struct Vector *v, int *indices);
+
+/* Multithreaded sample sort over the same keys; nthreads 0 means every
+   online CPU. The result is identical for any thread count, and the
+   argsort is stable with 64-bit indices. Small inputs use fewer threads. */
+int vec_sort_parallel(struct Vector *v, int nthreads);
+int vec_argsort_parallel(const struct Vector *v, int64_t *indices, int nthreads);
+
+/* The k largest (topk) or smallest (bottomk) elements, best first, into
+   values[0..k) and / or indices[0..k) (either may be NULL). Ties go to the
+   lower index, NaNs are skipped, and slots beyond the non-NaN count get
+   NaN / SIZE_MAX. O(n) plus O(log k) per element that enters the running
+   top k. The _parallel forms scan one chunk per thread (nthreads 0: every
+   online CPU) and give the same answer. */
+int vec_topk(const struct Vector *v, size_t k, double *values, size_t *indices);
+int vec_bottomk(const struct Vector *v, size_t k, double *values, size_t *indices);
+int vec_topk_parallel(const struct Vector *v, size_t k, double *values, size_t *indices, int nthreads);
+int vec_bottomk_parallel(const struct Vector *v, size_t k, double *values, size_t *indices, int nthreads);
 double vec_kth(const struct Vector *v, size_t k);
 
-/* distance functions */
+/* distance functions
+   NaN (errno set) on a NULL or size mismatch; cosine is also NaN when
+   either vector is all zeros. */
 double vec_l1_distance(const struct Vector *a, const struct Vector *b);
 double vec_l2_distance(const struct Vector *a, const struct Vector *b);
 double vec_cosine_similarity(const struct Vector *a, const struct Vector *b);
 
+/* One query against a block of candidates: rows is row-major count x
+   q->size and out receives one score per row, computed with a single dgemv
+   sweep over the block. sq_norms holds each row's squared norm, from
+   vec_row_sq_norms; pass it in when the same block is scored repeatedly, or
+   NULL to compute it on the fly. Batched L2 uses the norm expansion, so
+   distances between near-identical rows lose relative precision (negative
+   round-off is clamped to 0); use vec_l2_distance where that matters. A
+   NaN or infinite component, in the query or a row, gives NaN or inf for
+   that row, never a distance of 0. */
+int vec_row_sq_norms(const double *rows, size_t count, size_t dim, double *sq_norms);
+int vec_dot_batch(const struct Vector *q, const double *rows, size_t count, double *out);
+int vec_l2_distance_batch(const struct Vector *q, const double *rows, size_t count,
+                          const double *sq_norms, double *out);
+int vec_cosine_similarity_batch(const struct Vector *q, const double *rows, size_t count,
+                                const double *sq_norms, double *out);
+
+/* All pairs between two row-major blocks a (na x dim) and b (nb x dim):
+   out is na x nb row-major with out[i * nb + j] scoring a row i against b
+   row j. Computed tile by tile with dgemm and the norm expansion (the same
+   precision and NaN behaviour as the batched L2 above); cosine against a
+   zero row is NaN. a and b may be the same block. nthreads 0 means every
+   online CPU, 1 the caller alone. Only one layer threads: when OpenBLAS
+   runs more than one thread of its own, nthreads is ignored and the call
+   hands OpenBLAS whole row panels on the caller's thread, so set
+   OPENBLAS_NUM_THREADS=1 to use nthreads instead.
+   vec_pairwise_tiles never materialises the whole matrix: each finished
+   tile goes to sink.emit, one tile at a time per thread and possibly from
+   several threads at once. A nonzero return (errno set) stops that
+   thread and fails the call. */
+#define VEC_PAIR_DOT    0
+#define VEC_PAIR_L2     1
+#define VEC_PAIR_COSINE 2
+
+typedef int (*vec_tile_fn)(void *ctx, size_t row, size_t col, size_t rows, size_t cols,
+                           const double *tile, size_t ld);
+
+struct VecTileSink{
+	vec_tile_fn emit;
+	void *ctx;
+};
+
+int vec_gram(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+             double *out, int nthreads);
+int vec_pairwise_l2(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+                    double *out, int nthreads);
+int vec_pairwise_cosine(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+                        double *out, int nthreads);
+int vec_pairwise_tiles(int metric, const double *a, size_t na, const double *b, size_t nb,
+                       size_t dim, struct VecTileSink sink, int nthreads);
+
 
 #endif
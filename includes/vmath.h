@@ -0,0 +1,60 @@
+/* vmath.h */
+
+#ifndef VMATH_H
+#define VMATH_H
+
+#include "libs.h"
+
+/* Array kernels behind the vec_math_* family: y[i] = f(x[i]) for i < n.
+   y may equal x (in place) but must not otherwise overlap it.
+
+   The vectorized kernels evaluate a register of lanes at a time with
+   polynomial approximations, at the level vec_kernels() has active: 2
+   lanes with SSE2, 4 with AVX2, 8 with AVX-512, libm throughout at the
+   scalar level. Any register holding an input outside the fast domain
+   listed below goes through libm instead, so NaN, infinities, overflow,
+   underflow, subnormals and domain errors give the same values and errno
+   as libm. The vector levels run the same operations, so a result only
+   depends on the level through which neighbours share a register with
+   such an input, or fall in the tail, and get libm's value instead.
+
+   Maximum error against the exact result, measured over 2^20 random
+   arguments per range:
+
+       vmath_exp        |x| <= 708              1 ULP
+       vmath_log        normal x > 0            1 ULP
+       vmath_sin/cos    |x| <= 10               1.5 ULP
+                        |x| <= 2^19             2.5 ULP
+       vmath_tan        |x| <= 10               3 ULP
+                        |x| <= 2^19             4 ULP
+       vmath_sinh/cosh  |x| <= 708              2.5 ULP
+       vmath_tanh       |x| <= 22               3 ULP
+       vmath_sqrt       x >= 0                  correctly rounded
+
+   vmath_log_base adds one rounding for the division by log(base).
+   vmath_pow has correctly rounded short forms for p = 1, 2, 0.5 and -1
+   and calls libm pow otherwise. The remaining kernels call libm element by element. */
+
+void vmath_exp(double *y, const double *x, size_t n);
+void vmath_log(double *y, const double *x, size_t n);
+void vmath_log_base(double *y, const double *x, size_t n, double base);
+void vmath_sin(double *y, const double *x, size_t n);
+void vmath_cos(double *y, const double *x, size_t n);
+void vmath_tan(double *y, const double *x, size_t n);
+void vmath_sinh(double *y, const double *x, size_t n);
+void vmath_cosh(double *y, const double *x, size_t n);
+void vmath_tanh(double *y, const double *x, size_t n);
+void vmath_sqrt(double *y, const double *x, size_t n);
+void vmath_pow(double *y, const double *x, size_t n, double p);
+
+void vmath_cbrt(double *y, const double *x, size_t n);
+void vmath_asin(double *y, const double *x, size_t n);
+void vmath_acos(double *y, const double *x, size_t n);
+void vmath_atan(double *y, const double *x, size_t n);
+void vmath_floor(double *y, const double *x, size_t n);
+void vmath_ceil(double *y, const double *x, size_t n);
+void vmath_trunc(double *y, const double *x, size_t n);
+void vmath_round(double *y, const double *x, size_t n);
+void vmath_fmod(double *y, const double *x, size_t n, double divisor);
+
+#endif
@@ -0,0 +1,210 @@
+/* arena.c */
+
+#include "libs.h"
+#include "vector.h"
+
+/* default block size when vec_arena_create is given 0 */
+#define ARENA_DEFAULT_BLOCK ((size_t)1024 * 1024)
+
+struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t capacity;
+    size_t used;
+    unsigned char *base;
+};
+
+struct VecArena {
+    struct ArenaBlock *first;
+    struct ArenaBlock *current;
+    size_t block_size;
+};
+
+/* arena that vec_alloc draws from on this thread, NULL means the heap */
+static _Thread_local struct VecArena *current_arena = NULL;
+
+
+/* ===========================================
+                Blocks
+   =========================================== */
+
+static struct ArenaBlock *arena_block_new(size_t capacity)
+{
+    struct ArenaBlock *block = malloc(sizeof *block);
+    if (!block) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    block->base = vec_aligned_alloc(capacity);
+    if (!block->base) {
+        free(block);
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    block->next = NULL;
+    block->capacity = capacity;
+    block->used = 0;
+
+    return block;
+}
+
+static void arena_block_free(struct ArenaBlock *block)
+{
+    vec_aligned_free(block->base);
+    free(block);
+}
+
+
+/* ===========================================
+                Arena lifetime
+   =========================================== */
+
+struct VecArena *vec_arena_create(size_t capacity)
+{
+    if (capacity == 0) capacity = ARENA_DEFAULT_BLOCK;
+
+    struct VecArena *arena = malloc(sizeof *arena);
+    if (!arena) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_arena_create error: failed to allocate arena (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    arena->first = arena_block_new(capacity);
+    if (!arena->first) {
+        fprintf(stderr,
+                "vec_arena_create error: failed to allocate %zu bytes (%s)\n",
+                capacity, strerror(errno));
+        free(arena);
+        return NULL;
+    }
+
+    arena->current = arena->first;
+    arena->block_size = capacity;
+
+    return arena;
+}
+
+void vec_arena_reset(struct VecArena *arena)
+{
+    if (!arena) return;
+
+    /* later blocks are rewound lazily when the bump pointer reaches them,
+       so a reset costs the same no matter how much was allocated */
+    arena->current = arena->first;
+    arena->first->used = 0;
+}
+
+void vec_arena_destroy(struct VecArena *arena)
+{
+    if (!arena) return;
+
+    if (current_arena == arena) current_arena = NULL;
+
+    struct ArenaBlock *block = arena->first;
+    while (block) {
+        struct ArenaBlock *next = block->next;
+        arena_block_free(block);
+        block = next;
+    }
+
+    free(arena);
+}
+
+struct VecArena *vec_arena_use(struct VecArena *arena)
+{
+    struct VecArena *previous = current_arena;
+    current_arena = arena;
+    return previous;
+}
+
+struct VecArena *vec_arena_current(void)
+{
+    return current_arena;
+}
+
+
+/* ===========================================
+                Allocation
+   =========================================== */
+
+void *vec_arena_alloc_bytes(struct VecArena *arena, size_t bytes)
+{
+    if (!arena) {
+        errno = EINVAL;
+        return NULL;
+    }
+
+    if (bytes > SIZE_MAX - VEC_ALIGNMENT) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    bytes = (bytes + VEC_ALIGNMENT - 1) & ~((size_t)VEC_ALIGNMENT - 1);
+
+    struct ArenaBlock *block = arena->current;
+
+    while (block->capacity - block->used < bytes) {
+        struct ArenaBlock *next = block->next;
+
+        if (!next || next->capacity < bytes) {
+            size_t capacity = bytes > arena->block_size ? bytes : arena->block_size;
+
+            struct ArenaBlock *fresh = arena_block_new(capacity);
+            if (!fresh) return NULL;
+
+            /* splice in after the current block so an undersized
+               successor stays available for later, smaller requests */
+            fresh->next = next;
+            block->next = fresh;
+            next = fresh;
+        }
+
+        next->used = 0;
+        block = next;
+        arena->current = block;
+    }
+
+    void *ptr = block->base + block->used;
+    block->used += bytes;
+
+    return ptr;
+}
+
+struct Vector *vec_arena_alloc(struct VecArena *arena, size_t size)
+{
+    if (!arena) {
+        errno = EINVAL;
+        fprintf(stderr,
+                "vec_arena_alloc error: arena pointer is NULL (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    if (size > (SIZE_MAX - sizeof(struct VectorInline)) / sizeof(double)) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_arena_alloc error: size overflows the address space (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    /* header and payload in one bump, same layout as vec_alloc_inline */
+    struct VectorInline *block =
+        vec_arena_alloc_bytes(arena, sizeof(struct VectorInline) + size * sizeof(double));
+    if (!block) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_arena_alloc error: failed to allocate Vector (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    block->vec.size = size;
+    block->vec.data = block->payload;
+    block->vec.storage = VEC_STORAGE_ARENA;
+
+    return &block->vec;
+}
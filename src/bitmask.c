@@ -0,0 +1,585 @@
+/* bitmask.c */
+
+#include "libs.h"
+#include "bitmask.h"
+#include "kernels.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define EPS VEC_EQ_EPS   /* same tolerance as vec_eq */
+
+/* ===========================================
+                Bit helpers
+   =========================================== */
+
+static inline unsigned popcount64(uint64_t w)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ull);
+    w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+    w = (w + (w >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (unsigned)((w * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+static inline unsigned ctz64(uint64_t w)
+{
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(w);
+#else
+    unsigned n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+#endif
+}
+
+/* mask selecting the valid bits of the last word */
+static inline uint64_t tail_bits(size_t size)
+{
+    size_t r = size % 64;
+    return r ? ((uint64_t)1 << r) - 1 : ~(uint64_t)0;
+}
+
+/* ===========================================
+                Creation / destruction
+   =========================================== */
+
+struct BitMask *mask_alloc(size_t size)
+{
+    struct BitMask *m = malloc(sizeof *m);
+    if (!m) {
+        errno = ENOMEM;
+        fprintf(stderr, "mask_alloc error: failed to allocate BitMask struct (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    m->size = size;
+    m->words = vec_aligned_alloc(MASK_WORDS(size) * sizeof(uint64_t));
+    if (!m->words) {
+        errno = ENOMEM;
+        fprintf(stderr, "mask_alloc error: failed to allocate %zu words (%s)\n",
+                MASK_WORDS(size), strerror(errno));
+        free(m);
+        return NULL;
+    }
+
+    /* keep the padding bits of the last word at zero from the start */
+    if (size > 0) m->words[MASK_WORDS(size) - 1] = 0;
+
+    return m;
+}
+
+struct BitMask *mask_zeros(size_t size)
+{
+    struct BitMask *m = mask_alloc(size);
+    if (!m) return NULL;
+
+    memset(m->words, 0, MASK_WORDS(size) * sizeof(uint64_t));
+    return m;
+}
+
+void dest_mask(struct BitMask *mask)
+{
+    if (!mask) return;
+
+    vec_aligned_free(mask->words);
+    free(mask);
+}
+
+/* ===========================================
+                Element access / conversion
+   =========================================== */
+
+int mask_get(const struct BitMask *mask, size_t i)
+{
+    if (!mask || i >= mask->size) return 0;
+
+    return (int)((mask->words[i / 64] >> (i % 64)) & 1);
+}
+
+void mask_set(struct BitMask *mask, size_t i, int value)
+{
+    if (!mask || i >= mask->size) return;
+
+    uint64_t bit = (uint64_t)1 << (i % 64);
+    if (value) mask->words[i / 64] |= bit;
+    else       mask->words[i / 64] &= ~bit;
+}
+
+struct BitMask *mask_from_vec(const struct Vector *v)
+{
+    if (!v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "mask_from_vec error: vector pointer is NULL\n");
+        return NULL;
+    }
+
+    struct BitMask *m = mask_alloc(v->size);
+    if (!m) return NULL;
+
+    for (size_t w = 0; w < MASK_WORDS(v->size); w++) {
+        size_t base = w * 64;
+        size_t n = v->size - base < 64 ? v->size - base : 64;
+        uint64_t word = 0;
+
+        for (size_t j = 0; j < n; j++)
+            word |= (uint64_t)(v->data[base + j] != 0.0) << j;
+
+        m->words[w] = word;
+    }
+
+    return m;
+}
+
+struct Vector *vec_from_mask(const struct BitMask *mask)
+{
+    if (!mask || !mask->words) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_from_mask error: mask pointer is NULL\n");
+        return NULL;
+    }
+
+    struct Vector *v = vec_alloc(mask->size);
+    if (!v) return NULL;
+
+    for (size_t i = 0; i < mask->size; i++)
+        v->data[i] = (double)((mask->words[i / 64] >> (i % 64)) & 1);
+
+    return v;
+}
+
+/* ===========================================
+                Mask algebra
+   =========================================== */
+
+static int check_masks(const char *fn, const struct BitMask *dst,
+                       const struct BitMask *a, const struct BitMask *b)
+{
+    if (!dst || !a || !b || !dst->words || !a->words || !b->words) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: mask pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (dst->size != a->size || a->size != b->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: mask sizes differ\n", fn);
+        return -1;
+    }
+
+    return 0;
+}
+
+int mask_and(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b)
+{
+    if (check_masks("mask_and", dst, a, b) != 0) return -1;
+
+    for (size_t w = 0; w < MASK_WORDS(a->size); w++)
+        dst->words[w] = a->words[w] & b->words[w];
+
+    return 0;
+}
+
+int mask_or(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b)
+{
+    if (check_masks("mask_or", dst, a, b) != 0) return -1;
+
+    for (size_t w = 0; w < MASK_WORDS(a->size); w++)
+        dst->words[w] = a->words[w] | b->words[w];
+
+    return 0;
+}
+
+int mask_xor(struct BitMask *dst, const struct BitMask *a, const struct BitMask *b)
+{
+    if (check_masks("mask_xor", dst, a, b) != 0) return -1;
+
+    for (size_t w = 0; w < MASK_WORDS(a->size); w++)
+        dst->words[w] = a->words[w] ^ b->words[w];
+
+    return 0;
+}
+
+int mask_not(struct BitMask *dst, const struct BitMask *a)
+{
+    if (check_masks("mask_not", dst, a, a) != 0) return -1;
+
+    size_t words = MASK_WORDS(a->size);
+    for (size_t w = 0; w < words; w++)
+        dst->words[w] = ~a->words[w];
+
+    /* the padding bits flipped to one, put them back */
+    if (words > 0) dst->words[words - 1] &= tail_bits(a->size);
+
+    return 0;
+}
+
+size_t mask_popcount(const struct BitMask *mask)
+{
+    if (!mask || !mask->words) return 0;
+
+    size_t count = 0;
+    for (size_t w = 0; w < MASK_WORDS(mask->size); w++)
+        count += popcount64(mask->words[w]);
+
+    return count;
+}
+
+/* ===========================================
+                Compare kernels
+   =========================================== */
+
+enum CmpOp { CMP_GT, CMP_LT, CMP_EQ };
+
+static inline int cmp1(double x, double y, enum CmpOp op)
+{
+    switch (op) {
+    case CMP_GT: return x > y;
+    case CMP_LT: return x < y;
+    default:     return fabs(x - y) < EPS;
+    }
+}
+
+/* packs op(a[j], b[j]) for j < n (n <= 64) into one word. With scalar set,
+   b points at a single value that is compared against every a[j]. */
+static uint64_t cmp_word(const double *a, const double *b, int scalar, size_t n, enum CmpOp op)
+{
+    uint64_t word = 0;
+    size_t j = 0;
+
+#if defined(__SSE2__)
+    const __m128d sign = _mm_set1_pd(-0.0);
+    const __m128d eps = _mm_set1_pd(EPS);
+    const __m128d bs = _mm_set1_pd(b[0]);
+
+    /* two lanes per compare, movemask drops the results straight into bits */
+    for (; j + 2 <= n; j += 2) {
+        __m128d x = _mm_loadu_pd(a + j);
+        __m128d y = scalar ? bs : _mm_loadu_pd(b + j);
+        __m128d r;
+
+        if (op == CMP_GT)      r = _mm_cmpgt_pd(x, y);
+        else if (op == CMP_LT) r = _mm_cmplt_pd(x, y);
+        else                   r = _mm_cmplt_pd(_mm_andnot_pd(sign, _mm_sub_pd(x, y)), eps);
+
+        word |= (uint64_t)_mm_movemask_pd(r) << j;
+    }
+#endif
+
+    for (; j < n; j++)
+        word |= (uint64_t)cmp1(a[j], scalar ? b[0] : b[j], op) << j;
+
+    return word;
+}
+
+static void cmp_fill(struct BitMask *dst, const double *a, const double *b, int scalar,
+                     size_t size, enum CmpOp op)
+{
+    for (size_t w = 0; w < MASK_WORDS(size); w++) {
+        size_t base = w * 64;
+        size_t n = size - base < 64 ? size - base : 64;
+
+        dst->words[w] = cmp_word(a + base, scalar ? b : b + base, scalar, n, op);
+    }
+}
+
+static int cmp_into(const char *fn, struct BitMask *dst, const struct Vector *a,
+                    const struct Vector *b, enum CmpOp op)
+{
+    if (!dst || !dst->words || !a || !a->data || !b || !b->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL mask or vector\n", fn);
+        return -1;
+    }
+
+    if (a->size != b->size || dst->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch\n", fn);
+        return -1;
+    }
+
+    cmp_fill(dst, a->data, b->data, 0, a->size, op);
+    return 0;
+}
+
+static int cmp_scalar_into(const char *fn, struct BitMask *dst, const struct Vector *v,
+                           double s, enum CmpOp op)
+{
+    if (!dst || !dst->words || !v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL mask or vector\n", fn);
+        return -1;
+    }
+
+    if (dst->size != v->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch\n", fn);
+        return -1;
+    }
+
+    cmp_fill(dst, v->data, &s, 1, v->size, op);
+    return 0;
+}
+
+int vec_gt_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b)
+{
+    return cmp_into("vec_gt_mask_into", dst, a, b, CMP_GT);
+}
+
+int vec_lt_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b)
+{
+    return cmp_into("vec_lt_mask_into", dst, a, b, CMP_LT);
+}
+
+int vec_eq_mask_into(struct BitMask *dst, const struct Vector *a, const struct Vector *b)
+{
+    return cmp_into("vec_eq_mask_into", dst, a, b, CMP_EQ);
+}
+
+int vec_gt_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s)
+{
+    return cmp_scalar_into("vec_gt_scalar_mask_into", dst, v, s, CMP_GT);
+}
+
+int vec_lt_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s)
+{
+    return cmp_scalar_into("vec_lt_scalar_mask_into", dst, v, s, CMP_LT);
+}
+
+int vec_eq_scalar_mask_into(struct BitMask *dst, const struct Vector *v, double s)
+{
+    return cmp_scalar_into("vec_eq_scalar_mask_into", dst, v, s, CMP_EQ);
+}
+
+static struct BitMask *cmp_new(const char *fn, const struct Vector *a, const struct Vector *b,
+                               double s, int scalar, enum CmpOp op)
+{
+    if (!a || !a->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return NULL;
+    }
+
+    struct BitMask *m = mask_alloc(a->size);
+    if (!m) return NULL;
+
+    int rc = scalar ? cmp_scalar_into(fn, m, a, s, op) : cmp_into(fn, m, a, b, op);
+    if (rc != 0) {
+        dest_mask(m);
+        return NULL;
+    }
+
+    return m;
+}
+
+struct BitMask *vec_gt_mask(const struct Vector *a, const struct Vector *b)
+{
+    return cmp_new("vec_gt_mask", a, b, 0.0, 0, CMP_GT);
+}
+
+struct BitMask *vec_lt_mask(const struct Vector *a, const struct Vector *b)
+{
+    return cmp_new("vec_lt_mask", a, b, 0.0, 0, CMP_LT);
+}
+
+struct BitMask *vec_eq_mask(const struct Vector *a, const struct Vector *b)
+{
+    return cmp_new("vec_eq_mask", a, b, 0.0, 0, CMP_EQ);
+}
+
+struct BitMask *vec_gt_scalar_mask(const struct Vector *v, double s)
+{
+    return cmp_new("vec_gt_scalar_mask", v, NULL, s, 1, CMP_GT);
+}
+
+struct BitMask *vec_lt_scalar_mask(const struct Vector *v, double s)
+{
+    return cmp_new("vec_lt_scalar_mask", v, NULL, s, 1, CMP_LT);
+}
+
+struct BitMask *vec_eq_scalar_mask(const struct Vector *v, double s)
+{
+    return cmp_new("vec_eq_scalar_mask", v, NULL, s, 1, CMP_EQ);
+}
+
+/* ===========================================
+                Selection
+   =========================================== */
+
+struct Vector *vec_where_mask(const struct BitMask *mask, const struct Vector *a, const struct Vector *b)
+{
+    if (!mask || !mask->words || !a || !a->data || !b || !b->data) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_where_mask error: NULL mask or vector\n");
+        return NULL;
+    }
+
+    if (a->size != b->size || mask->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_where_mask error: size mismatch\n");
+        return NULL;
+    }
+
+    struct Vector *out = vec_alloc(a->size);
+    if (!out) return NULL;
+
+    for (size_t w = 0; w < MASK_WORDS(a->size); w++) {
+        size_t base = w * 64;
+        size_t n = a->size - base < 64 ? a->size - base : 64;
+        uint64_t word = mask->words[w];
+
+        /* select without a branch: the compiler turns this into a blend */
+        for (size_t j = 0; j < n; j++)
+            out->data[base + j] = ((word >> j) & 1) ? a->data[base + j] : b->data[base + j];
+    }
+
+    return out;
+}
+
+struct Vector *vec_filter_mask(const struct Vector *v, const struct BitMask *mask)
+{
+    if (!mask || !mask->words || !v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_filter_mask error: NULL mask or vector\n");
+        return NULL;
+    }
+
+    if (mask->size != v->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_filter_mask error: size mismatch\n");
+        return NULL;
+    }
+
+    struct Vector *out = vec_alloc(mask_popcount(mask));
+    if (!out) return NULL;
+
+    size_t k = 0;
+    for (size_t w = 0; w < MASK_WORDS(v->size); w++) {
+        uint64_t word = mask->words[w];
+        const double *x = v->data + w * 64;
+
+        /* visit set bits only; empty words cost one test */
+        while (word) {
+            out->data[k++] = x[ctz64(word)];
+            word &= word - 1;
+        }
+    }
+
+    return out;
+}
+
+/* ===========================================
+                Selection by 0 / 1 vectors
+   =========================================== */
+
+/* Same rules as the bitmask forms, with a double mask where any nonzero
+   (NaN included) selects, as in mask_from_vec */
+struct Vector *vec_where(const struct Vector *mask, const struct Vector *a, const struct Vector *b)
+{
+    if (!mask || !mask->data || !a || !a->data || !b || !b->data) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_where error: NULL mask or vector\n");
+        return NULL;
+    }
+
+    if (a->size != b->size || mask->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_where error: size mismatch\n");
+        return NULL;
+    }
+
+    struct Vector *out = vec_alloc(a->size);
+    if (!out) return NULL;
+
+    vec_kernels()->where(out->data, mask->data, a->data, b->data, a->size);
+    return out;
+}
+
+struct FilterTask{
+    const struct Vector *v, *mask;
+    struct Vector *out;
+    int threads, id;
+    size_t count, offset;
+};
+
+static void filter_range(const struct FilterTask *task, size_t *begin, size_t *end)
+{
+    *begin = task->v->size * (size_t)task->id / (size_t)task->threads;
+    *end = task->v->size * (size_t)(task->id + 1) / (size_t)task->threads;
+}
+
+static void *filter_count(void *arg)
+{
+    struct FilterTask *task = arg;
+    size_t begin, end;
+
+    filter_range(task, &begin, &end);
+    task->count = vec_kernels()->count_nonzero(task->mask->data + begin, end - begin);
+    return NULL;
+}
+
+static void *filter_scatter(void *arg)
+{
+    struct FilterTask *task = arg;
+    size_t begin, end;
+
+    filter_range(task, &begin, &end);
+    vec_kernels()->compress(task->out->data + task->offset, task->v->data + begin,
+                            task->mask->data + begin, end - begin, task->count);
+    return NULL;
+}
+
+/* Two passes: each thread counts its chunk's selected elements, a prefix
+   sum gives every chunk its output offset, then each thread compacts its
+   chunk straight into place. The output is the same for any thread
+   count; below a few chunks' worth it runs on the caller alone. */
+static struct Vector *filter(const char *fn, const struct Vector *v, const struct Vector *mask, int nthreads)
+{
+    if (!mask || !mask->data || !v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL mask or vector\n", fn);
+        return NULL;
+    }
+
+    if (mask->size != v->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch\n", fn);
+        return NULL;
+    }
+
+    int T = nthreads == 1 ? 1 : vec_parallel_threads(nthreads, v->size);
+    struct FilterTask tasks[VEC_MAX_THREADS];
+
+    for (int t = 0; t < T; t++)
+        tasks[t] = (struct FilterTask){ v, mask, NULL, T, t, 0, 0 };
+    vec_run_parallel(filter_count, tasks, sizeof tasks[0], T);
+
+    size_t total = 0;
+    for (int t = 0; t < T; t++) {
+        tasks[t].offset = total;
+        total += tasks[t].count;
+    }
+
+    struct Vector *out = vec_alloc(total);
+    if (!out) return NULL;
+
+    for (int t = 0; t < T; t++) tasks[t].out = out;
+    vec_run_parallel(filter_scatter, tasks, sizeof tasks[0], T);
+
+    return out;
+}
+
+struct Vector *vec_filter(const struct Vector *v, const struct Vector *mask)
+{
+    return filter("vec_filter", v, mask, 1);
+}
+
+struct Vector *vec_filter_parallel(const struct Vector *v, const struct Vector *mask, int nthreads)
+{
+    return filter("vec_filter_parallel", v, mask, nthreads);
+}
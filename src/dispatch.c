@@ -0,0 +1,131 @@
+/* dispatch.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* ===========================================
+                CPU detection
+   =========================================== */
+
+static int detect_isa(void)
+{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __builtin_cpu_init();
+
+    /* __builtin_cpu_supports also checks that the OS saves the wide
+       registers (XGETBV), so a reported level is safe to run */
+    if (__builtin_cpu_supports("avx512f")) return VEC_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2"))    return VEC_ISA_AVX2;
+    if (__builtin_cpu_supports("sse2"))    return VEC_ISA_SSE2;
+#endif
+    return VEC_ISA_SCALAR;
+}
+
+static const char *isa_names[] = { "scalar", "sse2", "avx2", "avx512" };
+
+static const struct VecKernels *table_for(int isa)
+{
+    switch (isa) {
+#if defined(__x86_64__) || defined(__i386__)
+    case VEC_ISA_AVX512: return &vec_kernels_avx512;
+    case VEC_ISA_AVX2:   return &vec_kernels_avx2;
+    case VEC_ISA_SSE2:   return &vec_kernels_sse2;
+#endif
+    default:             return &vec_kernels_scalar;
+    }
+}
+
+/* ===========================================
+                Active level
+   =========================================== */
+
+/* The CPU is probed and the starting table picked exactly once, at load
+   time where the compiler supports constructors and otherwise on first
+   use; worker threads may be the first callers, so both go through
+   pthread_once. vec_set_isa swaps the table atomically afterwards. */
+static pthread_once_t dispatch_once = PTHREAD_ONCE_INIT;
+static int cpu_isa = VEC_ISA_SCALAR;                    /* written once */
+static _Atomic(const struct VecKernels *) active;
+
+static int env_isa(int best);
+
+static void dispatch_init(void)
+{
+    cpu_isa = detect_isa();
+    atomic_store_explicit(&active, table_for(env_isa(cpu_isa)), memory_order_release);
+}
+
+#if defined(__GNUC__)
+__attribute__((constructor))
+static void dispatch_startup(void)
+{
+    pthread_once(&dispatch_once, dispatch_init);
+}
+#endif
+
+int vec_cpu_isa(void)
+{
+    pthread_once(&dispatch_once, dispatch_init);
+    return cpu_isa;
+}
+
+const char *vec_isa_name(int isa)
+{
+    if (isa < VEC_ISA_SCALAR || isa > VEC_ISA_AVX512) return "unknown";
+    return isa_names[isa];
+}
+
+/* AXPY_ISA caps the level; asking for more than the CPU has is reported
+   and ignored rather than left to crash on the first kernel */
+static int env_isa(int best)
+{
+    const char *env = getenv("AXPY_ISA");
+    if (!env || !*env) return best;
+
+    for (int isa = VEC_ISA_SCALAR; isa <= VEC_ISA_AVX512; isa++) {
+        if (strcmp(env, isa_names[isa]) != 0) continue;
+
+        if (isa > best) {
+            fprintf(stderr, "vec dispatch warning: AXPY_ISA=%s not supported by this CPU, using %s\n",
+                    env, isa_names[best]);
+            return best;
+        }
+        return isa;
+    }
+
+    fprintf(stderr, "vec dispatch warning: unknown AXPY_ISA=%s, using %s\n", env, isa_names[best]);
+    return best;
+}
+
+const struct VecKernels *vec_kernels(void)
+{
+    pthread_once(&dispatch_once, dispatch_init);
+    return atomic_load_explicit(&active, memory_order_acquire);
+}
+
+int vec_get_isa(void)
+{
+    return vec_kernels()->isa;
+}
+
+int vec_set_isa(int isa)
+{
+    if (isa < VEC_ISA_SCALAR || isa > VEC_ISA_AVX512) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_set_isa error: unknown level %d\n", isa);
+        return -1;
+    }
+
+    if (isa > vec_cpu_isa()) {
+        errno = ENOTSUP;
+        fprintf(stderr, "vec_set_isa error: %s is not supported by this CPU\n", isa_names[isa]);
+        return -1;
+    }
+
+    atomic_store_explicit(&active, table_for(isa), memory_order_release);
+    return 0;
+}
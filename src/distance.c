@@ -0,0 +1,402 @@
+/* distance.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+/* elements of a - b held on the stack at a time: 4 KiB */
+#define DIFF_BLOCK 512
+
+/* rows handed to one dgemv call, so the row count fits CBLAS's int */
+#define GEMV_MAX_ROWS ((size_t)INT_MAX)
+
+/* output tile of the all-pairs functions: 512 KiB, sized to stay in L2
+   while its rows are post-processed, and the unit of work per thread.
+   When BLAS threads internally, a direct-output tile spans the full width
+   instead, so each dgemm is big enough to split across its threads. */
+#define PAIR_TILE_ROWS 256
+#define PAIR_TILE_COLS 256
+
+/* ===========================================
+                Pairwise distances
+   =========================================== */
+
+static int check_pair(const char *fn, const struct Vector *a, const struct Vector *b)
+{
+    if (!a || !b || (!a->data && a->size > 0) || (!b->data && b->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL vector\n", fn);
+        return -1;
+    }
+
+    if (a->size != b->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch\n", fn);
+        return -1;
+    }
+
+    if (a->size > (size_t)INT_MAX) {
+        errno = ERANGE;
+        fprintf(stderr, "%s error: vector too long for BLAS\n", fn);
+        return -1;
+    }
+
+    return 0;
+}
+
+double vec_l1_distance(const struct Vector *a, const struct Vector *b)
+{
+    if (check_pair("vec_l1_distance", a, b) != 0) return NAN;
+
+    const struct VecKernels *k = vec_kernels();
+    double diff[DIFF_BLOCK];
+    double dist = 0.0;
+
+    for (size_t off = 0; off < a->size; off += DIFF_BLOCK) {
+        size_t len = a->size - off < DIFF_BLOCK ? a->size - off : DIFF_BLOCK;
+        k->sub(diff, a->data + off, b->data + off, len);
+        dist += cblas_dasum((int)len, diff, 1);
+    }
+
+    return dist;
+}
+
+double vec_l2_distance(const struct Vector *a, const struct Vector *b)
+{
+    if (check_pair("vec_l2_distance", a, b) != 0) return NAN;
+
+    /* differences are formed directly rather than through the norm
+       expansion, so near-identical vectors keep their full precision */
+    const struct VecKernels *k = vec_kernels();
+    double diff[DIFF_BLOCK];
+    double dist = 0.0;
+
+    for (size_t off = 0; off < a->size; off += DIFF_BLOCK) {
+        size_t len = a->size - off < DIFF_BLOCK ? a->size - off : DIFF_BLOCK;
+        k->sub(diff, a->data + off, b->data + off, len);
+        dist = hypot(dist, cblas_dnrm2((int)len, diff, 1));
+    }
+
+    return dist;
+}
+
+double vec_cosine_similarity(const struct Vector *a, const struct Vector *b)
+{
+    if (check_pair("vec_cosine_similarity", a, b) != 0) return NAN;
+
+    double na = cblas_dnrm2((int)a->size, a->data, 1);
+    double nb = cblas_dnrm2((int)b->size, b->data, 1);
+
+    /* the angle to a zero vector is undefined */
+    if (na == 0.0 || nb == 0.0) return NAN;
+
+    return cblas_ddot((int)a->size, a->data, 1, b->data, 1) / na / nb;
+}
+
+/* ===========================================
+                One query against many rows
+   =========================================== */
+
+static int check_batch(const char *fn, const struct Vector *q, const double *rows,
+                       size_t count, double *out)
+{
+    if (!q || (!q->data && q->size > 0) || !out || (!rows && count > 0 && q->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL query, rows or output\n", fn);
+        return -1;
+    }
+
+    if (q->size > (size_t)INT_MAX) {
+        errno = ERANGE;
+        fprintf(stderr, "%s error: dimension too large for BLAS\n", fn);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* out = alpha * rows . q + beta * out, split so each call's row count fits
+   an int */
+static void block_gemv(const double *rows, size_t count, const struct Vector *q,
+                       double alpha, double beta, double *out)
+{
+    size_t dim = q->size;
+
+    if (dim == 0) {
+        for (size_t i = 0; i < count; i++) out[i] = beta == 0.0 ? 0.0 : beta * out[i];
+        return;
+    }
+
+    for (size_t off = 0; off < count; off += GEMV_MAX_ROWS) {
+        size_t m = count - off < GEMV_MAX_ROWS ? count - off : GEMV_MAX_ROWS;
+        cblas_dgemv(CblasRowMajor, CblasNoTrans, (int)m, (int)dim, alpha,
+                    rows + off * dim, (int)dim, q->data, 1, beta, out + off, 1);
+    }
+}
+
+int vec_row_sq_norms(const double *rows, size_t count, size_t dim, double *sq_norms)
+{
+    if (!sq_norms || (!rows && count > 0 && dim > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_row_sq_norms error: NULL rows or output\n");
+        return -1;
+    }
+
+    const struct VecKernels *k = vec_kernels();
+
+    for (size_t i = 0; i < count; i++) {
+        sq_norms[i] = dim ? k->sum_sq(rows + i * dim, dim) : 0.0;
+    }
+
+    return 0;
+}
+
+int vec_dot_batch(const struct Vector *q, const double *rows, size_t count, double *out)
+{
+    if (check_batch("vec_dot_batch", q, rows, count, out) != 0) return -1;
+
+    block_gemv(rows, count, q, 1.0, 0.0, out);
+    return 0;
+}
+
+int vec_l2_distance_batch(const struct Vector *q, const double *rows, size_t count,
+                          const double *sq_norms, double *out)
+{
+    if (check_batch("vec_l2_distance_batch", q, rows, count, out) != 0) return -1;
+
+    size_t dim = q->size;
+
+    /* |c - q|^2 = |c|^2 - 2 c.q + |q|^2: seed out with |c|^2 and let dgemv
+       fold in the cross term */
+    if (sq_norms) {
+        if (count > 0) memcpy(out, sq_norms, count * sizeof(double));
+    } else {
+        vec_row_sq_norms(rows, count, dim, out);
+    }
+
+    block_gemv(rows, count, q, -2.0, 1.0, out);
+
+    double qq = dim ? vec_kernels()->sum_sq(q->data, dim) : 0.0;
+
+    /* cancellation can leave a tiny negative for near-duplicates; only
+       that is clamped, so NaN from a non-finite row still comes through */
+    for (size_t i = 0; i < count; i++) {
+        double d2 = out[i] + qq;
+        out[i] = d2 < 0.0 ? 0.0 : sqrt(d2);
+    }
+
+    return 0;
+}
+
+int vec_cosine_similarity_batch(const struct Vector *q, const double *rows, size_t count,
+                                const double *sq_norms, double *out)
+{
+    if (check_batch("vec_cosine_similarity_batch", q, rows, count, out) != 0) return -1;
+
+    const struct VecKernels *k = vec_kernels();
+    size_t dim = q->size;
+
+    block_gemv(rows, count, q, 1.0, 0.0, out);
+
+    double nq = dim ? sqrt(k->sum_sq(q->data, dim)) : 0.0;
+
+    for (size_t i = 0; i < count; i++) {
+        double nc = sq_norms ? sqrt(sq_norms[i]) : (dim ? sqrt(k->sum_sq(rows + i * dim, dim)) : 0.0);
+        out[i] = (nq == 0.0 || nc == 0.0) ? NAN : out[i] / nq / nc;
+    }
+
+    return 0;
+}
+
+/* ===========================================
+                All pairs (GEMM)
+   =========================================== */
+
+struct PairShared{
+    int metric;
+    const double *a, *b;
+    size_t na, nb, dim;
+    const double *norm_a, *norm_b;  /* squared norms (L2) or 1 / norm (cosine) */
+    double *out;                    /* full na x nb result, or NULL for sink */
+    struct VecTileSink sink;
+    size_t tile_cols, tiles_c, tiles;
+    int threads;
+};
+
+struct PairTask{
+    const struct PairShared *sh;
+    double *buf;                    /* this thread's tile when streaming */
+    int id;
+    int rc, err;
+};
+
+static int tile_emit(const struct PairShared *sh, double *buf, size_t tile)
+{
+    size_t row = tile / sh->tiles_c * PAIR_TILE_ROWS;
+    size_t col = tile % sh->tiles_c * sh->tile_cols;
+    size_t rows = sh->na - row < PAIR_TILE_ROWS ? sh->na - row : PAIR_TILE_ROWS;
+    size_t cols = sh->nb - col < sh->tile_cols ? sh->nb - col : sh->tile_cols;
+    size_t ld = sh->out ? sh->nb : cols;
+    double *c = sh->out ? sh->out + row * sh->nb + col : buf;
+    double alpha = sh->metric == VEC_PAIR_L2 ? -2.0 : 1.0;
+
+    if (sh->dim == 0) {
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < cols; j++) c[i * ld + j] = 0.0;
+    } else {
+        cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasTrans, (int)rows, (int)cols, (int)sh->dim,
+                    alpha, sh->a + row * sh->dim, (int)sh->dim, sh->b + col * sh->dim, (int)sh->dim,
+                    0.0, c, (int)ld);
+    }
+
+    if (sh->metric == VEC_PAIR_L2) {
+        for (size_t i = 0; i < rows; i++) {
+            double *ci = c + i * ld;
+            double ai = sh->norm_a[row + i];
+            const double *bj = sh->norm_b + col;
+            for (size_t j = 0; j < cols; j++) {
+                double d2 = ci[j] + ai + bj[j];
+                ci[j] = d2 < 0.0 ? 0.0 : sqrt(d2);
+            }
+        }
+    } else if (sh->metric == VEC_PAIR_COSINE) {
+        for (size_t i = 0; i < rows; i++) {
+            double *ci = c + i * ld;
+            double ai = sh->norm_a[row + i];
+            const double *bj = sh->norm_b + col;
+            for (size_t j = 0; j < cols; j++) ci[j] = ci[j] * ai * bj[j];
+        }
+    }
+
+    if (sh->out) return 0;
+    return sh->sink.emit(sh->sink.ctx, row, col, rows, cols, c, ld);
+}
+
+static void *pair_worker(void *arg)
+{
+    struct PairTask *task = arg;
+    const struct PairShared *sh = task->sh;
+
+    /* tiles dealt round-robin; they are all the same cost except at the
+       right and bottom edges */
+    for (size_t t = (size_t)task->id; t < sh->tiles; t += (size_t)sh->threads) {
+        if (tile_emit(sh, task->buf, t) != 0) {
+            task->rc = -1;
+            task->err = errno;
+            break;
+        }
+    }
+    return NULL;
+}
+
+/* squared norms for L2, reciprocal norms (NaN for a zero row) for cosine */
+static void pair_norms(int metric, const double *rows, size_t count, size_t dim, double *out)
+{
+    vec_row_sq_norms(rows, count, dim, out);
+    if (metric == VEC_PAIR_COSINE) {
+        for (size_t i = 0; i < count; i++) out[i] = out[i] > 0.0 ? 1.0 / sqrt(out[i]) : NAN;
+    }
+}
+
+static int pairwise(const char *fn, int metric, const double *a, size_t na, const double *b,
+                    size_t nb, size_t dim, double *out, struct VecTileSink sink, int nthreads)
+{
+    if (metric != VEC_PAIR_DOT && metric != VEC_PAIR_L2 && metric != VEC_PAIR_COSINE) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: unknown metric %d\n", fn, metric);
+        return -1;
+    }
+
+    if ((!out && !sink.emit) || (dim > 0 && ((!a && na > 0) || (!b && nb > 0)))) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL input or output\n", fn);
+        return -1;
+    }
+
+    if (dim > (size_t)INT_MAX || (out && nb > (size_t)INT_MAX)) {
+        errno = ERANGE;
+        fprintf(stderr, "%s error: dimensions too large for BLAS\n", fn);
+        return -1;
+    }
+
+    if (na == 0 || nb == 0) return 0;
+
+    /* threads on both sides of the dgemm call would oversubscribe the
+       cores, so a multithreaded OpenBLAS gets the parallelism to itself */
+    int blas_threaded = openblas_get_num_threads() > 1;
+
+    struct PairShared sh = { metric, a, b, na, nb, dim, NULL, NULL, out, sink, PAIR_TILE_COLS, 0, 0, 1 };
+    if (blas_threaded && out) sh.tile_cols = nb;
+    sh.tiles_c = (nb + sh.tile_cols - 1) / sh.tile_cols;
+    sh.tiles = (na + PAIR_TILE_ROWS - 1) / PAIR_TILE_ROWS * sh.tiles_c;
+
+    size_t work = na > SIZE_MAX / nb ? SIZE_MAX : na * nb;
+    int T = nthreads == 1 || blas_threaded ? 1 : vec_parallel_threads(nthreads, work);
+    if ((size_t)T > sh.tiles) T = (int)sh.tiles;
+    sh.threads = T;
+
+    double *norms = NULL, *bufs = NULL;
+    if (metric != VEC_PAIR_DOT) norms = malloc((na + nb) * sizeof(double));
+    if (!out) bufs = malloc((size_t)T * PAIR_TILE_ROWS * PAIR_TILE_COLS * sizeof(double));
+    if ((metric != VEC_PAIR_DOT && !norms) || (!out && !bufs)) {
+        free(norms);
+        free(bufs);
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: failed to allocate work buffers\n", fn);
+        return -1;
+    }
+
+    if (norms) {
+        pair_norms(metric, a, na, dim, norms);
+        pair_norms(metric, b, nb, dim, norms + na);
+        sh.norm_a = norms;
+        sh.norm_b = norms + na;
+    }
+
+    struct PairTask tasks[VEC_MAX_THREADS];
+    for (int t = 0; t < T; t++) {
+        double *buf = bufs ? bufs + (size_t)t * PAIR_TILE_ROWS * PAIR_TILE_COLS : NULL;
+        tasks[t] = (struct PairTask){ &sh, buf, t, 0, 0 };
+    }
+    vec_run_parallel(pair_worker, tasks, sizeof tasks[0], T);
+
+    free(norms);
+    free(bufs);
+
+    for (int t = 0; t < T; t++) {
+        if (tasks[t].rc != 0) {
+            errno = tasks[t].err;
+            fprintf(stderr, "%s error: tile sink failed (%s)\n", fn, strerror(errno));
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int vec_gram(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+             double *out, int nthreads)
+{
+    struct VecTileSink none = { NULL, NULL };
+    return pairwise("vec_gram", VEC_PAIR_DOT, a, na, b, nb, dim, out, none, nthreads);
+}
+
+int vec_pairwise_l2(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+                    double *out, int nthreads)
+{
+    struct VecTileSink none = { NULL, NULL };
+    return pairwise("vec_pairwise_l2", VEC_PAIR_L2, a, na, b, nb, dim, out, none, nthreads);
+}
+
+int vec_pairwise_cosine(const double *a, size_t na, const double *b, size_t nb, size_t dim,
+                        double *out, int nthreads)
+{
+    struct VecTileSink none = { NULL, NULL };
+    return pairwise("vec_pairwise_cosine", VEC_PAIR_COSINE, a, na, b, nb, dim, out, none, nthreads);
+}
+
+int vec_pairwise_tiles(int metric, const double *a, size_t na, const double *b, size_t nb,
+                       size_t dim, struct VecTileSink sink, int nthreads)
+{
+    return pairwise("vec_pairwise_tiles", metric, a, na, b, nb, dim, NULL, sink, nthreads);
+}
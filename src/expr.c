@@ -0,0 +1,348 @@
+/* expr.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "expr.h"
+#include "kernels.h"
+#include "vmath.h"
+
+/* elements per block: a handful of intermediates at 4 KiB each stay in L1 */
+#define EXPR_BLOCK 512
+
+enum ExprOp {
+    OP_LEAF,
+
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+    OP_GT, OP_LT, OP_EQ,
+
+    OP_ADD_S, OP_SUB_S, OP_MUL_S, OP_DIV_S,
+    OP_GT_S, OP_LT_S, OP_EQ_S,
+
+    OP_EXP, OP_LOGE, OP_SQRT, OP_POW,
+    OP_SIN, OP_COS, OP_TAN,
+    OP_SINH, OP_COSH, OP_TANH,
+    OP_ABS
+};
+
+struct VecExpr {
+    struct VecGraph *graph;
+    enum ExprOp op;
+    struct VecExpr *a, *b;        /* operands, b only for vector-vector ops */
+    const struct Vector *leaf;    /* OP_LEAF only */
+    double param;                 /* scalar operand or power */
+    size_t size;
+    size_t id;                    /* creation order, operands always lower */
+    struct VecExpr *next;
+};
+
+struct VecGraph {
+    struct VecExpr *first, *last;
+    size_t count;
+};
+
+/* ===========================================
+                Graph
+   =========================================== */
+
+struct VecGraph *vec_graph_create(void)
+{
+    struct VecGraph *graph = calloc(1, sizeof *graph);
+    if (!graph) {
+        errno = ENOMEM;
+        fprintf(stderr, "vec_graph_create error: %s\n", strerror(errno));
+        return NULL;
+    }
+    return graph;
+}
+
+void vec_graph_destroy(struct VecGraph *graph)
+{
+    if (!graph) return;
+
+    struct VecExpr *node = graph->first;
+    while (node) {
+        struct VecExpr *next = node->next;
+        free(node);
+        node = next;
+    }
+    free(graph);
+}
+
+static struct VecExpr *new_node(const char *fn, struct VecGraph *graph, enum ExprOp op,
+                                struct VecExpr *a, struct VecExpr *b, double param, size_t size)
+{
+    struct VecExpr *node = malloc(sizeof *node);
+    if (!node) {
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: %s\n", fn, strerror(errno));
+        return NULL;
+    }
+
+    node->graph = graph;
+    node->op = op;
+    node->a = a;
+    node->b = b;
+    node->leaf = NULL;
+    node->param = param;
+    node->size = size;
+    node->id = graph->count++;
+    node->next = NULL;
+
+    if (graph->last) graph->last->next = node;
+    else graph->first = node;
+    graph->last = node;
+
+    return node;
+}
+
+struct VecExpr *vec_expr_vec(struct VecGraph *graph, const struct Vector *v)
+{
+    if (!graph || !v || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_expr_vec error: graph or vector pointer is NULL\n");
+        return NULL;
+    }
+
+    struct VecExpr *node = new_node("vec_expr_vec", graph, OP_LEAF, NULL, NULL, 0.0, v->size);
+    if (node) node->leaf = v;
+    return node;
+}
+
+/* ===========================================
+                Builders
+   =========================================== */
+
+static struct VecExpr *binary(const char *fn, enum ExprOp op, struct VecExpr *a, struct VecExpr *b)
+{
+    /* an earlier builder already reported the failure */
+    if (!a || !b) return NULL;
+
+    if (a->graph != b->graph) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: operands belong to different graphs\n", fn);
+        return NULL;
+    }
+
+    if (a->size != b->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (%zu vs %zu)\n", fn, a->size, b->size);
+        return NULL;
+    }
+
+    return new_node(fn, a->graph, op, a, b, 0.0, a->size);
+}
+
+static struct VecExpr *unary(const char *fn, enum ExprOp op, struct VecExpr *e, double param)
+{
+    if (!e) return NULL;
+    return new_node(fn, e->graph, op, e, NULL, param, e->size);
+}
+
+struct VecExpr *vec_expr_add(struct VecExpr *a, struct VecExpr *b) { return binary("vec_expr_add", OP_ADD, a, b); }
+struct VecExpr *vec_expr_sub(struct VecExpr *a, struct VecExpr *b) { return binary("vec_expr_sub", OP_SUB, a, b); }
+struct VecExpr *vec_expr_mul(struct VecExpr *a, struct VecExpr *b) { return binary("vec_expr_mul", OP_MUL, a, b); }
+struct VecExpr *vec_expr_div(struct VecExpr *a, struct VecExpr *b) { return binary("vec_expr_div", OP_DIV, a, b); }
+struct VecExpr *vec_expr_gt(struct VecExpr *a, struct VecExpr *b)  { return binary("vec_expr_gt", OP_GT, a, b); }
+struct VecExpr *vec_expr_lt(struct VecExpr *a, struct VecExpr *b)  { return binary("vec_expr_lt", OP_LT, a, b); }
+struct VecExpr *vec_expr_eq(struct VecExpr *a, struct VecExpr *b)  { return binary("vec_expr_eq", OP_EQ, a, b); }
+
+struct VecExpr *vec_expr_add_scalar(struct VecExpr *e, double s) { return unary("vec_expr_add_scalar", OP_ADD_S, e, s); }
+struct VecExpr *vec_expr_sub_scalar(struct VecExpr *e, double s) { return unary("vec_expr_sub_scalar", OP_SUB_S, e, s); }
+struct VecExpr *vec_expr_mul_scalar(struct VecExpr *e, double s) { return unary("vec_expr_mul_scalar", OP_MUL_S, e, s); }
+struct VecExpr *vec_expr_gt_scalar(struct VecExpr *e, double s)  { return unary("vec_expr_gt_scalar", OP_GT_S, e, s); }
+struct VecExpr *vec_expr_lt_scalar(struct VecExpr *e, double s)  { return unary("vec_expr_lt_scalar", OP_LT_S, e, s); }
+struct VecExpr *vec_expr_eq_scalar(struct VecExpr *e, double s)  { return unary("vec_expr_eq_scalar", OP_EQ_S, e, s); }
+
+struct VecExpr *vec_expr_div_scalar(struct VecExpr *e, double s)
+{
+    if (!e) return NULL;
+
+    /* same rule as vec_div_scalar, caught when the node is built */
+    if (s == 0.0) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_expr_div_scalar error: division by zero scalar\n");
+        return NULL;
+    }
+    return unary("vec_expr_div_scalar", OP_DIV_S, e, s);
+}
+
+struct VecExpr *vec_expr_exp(struct VecExpr *e)  { return unary("vec_expr_exp", OP_EXP, e, 0.0); }
+struct VecExpr *vec_expr_loge(struct VecExpr *e) { return unary("vec_expr_loge", OP_LOGE, e, 0.0); }
+struct VecExpr *vec_expr_sqrt(struct VecExpr *e) { return unary("vec_expr_sqrt", OP_SQRT, e, 0.0); }
+struct VecExpr *vec_expr_sin(struct VecExpr *e)  { return unary("vec_expr_sin", OP_SIN, e, 0.0); }
+struct VecExpr *vec_expr_cos(struct VecExpr *e)  { return unary("vec_expr_cos", OP_COS, e, 0.0); }
+struct VecExpr *vec_expr_tan(struct VecExpr *e)  { return unary("vec_expr_tan", OP_TAN, e, 0.0); }
+struct VecExpr *vec_expr_sinh(struct VecExpr *e) { return unary("vec_expr_sinh", OP_SINH, e, 0.0); }
+struct VecExpr *vec_expr_cosh(struct VecExpr *e) { return unary("vec_expr_cosh", OP_COSH, e, 0.0); }
+struct VecExpr *vec_expr_tanh(struct VecExpr *e) { return unary("vec_expr_tanh", OP_TANH, e, 0.0); }
+struct VecExpr *vec_expr_abs(struct VecExpr *e)  { return unary("vec_expr_abs", OP_ABS, e, 0.0); }
+
+struct VecExpr *vec_expr_pow(struct VecExpr *e, double power)
+{
+    return unary("vec_expr_pow", OP_POW, e, power);
+}
+
+size_t vec_expr_size(const struct VecExpr *e)
+{
+    return e ? e->size : 0;
+}
+
+/* ===========================================
+                Fused evaluation
+   =========================================== */
+
+/* one node over one block; x / y are the operand blocks */
+static void eval_block(const struct VecKernels *k, const struct VecExpr *e,
+                       double *out, const double *x, const double *y, size_t n)
+{
+    double s = e->param;
+
+    switch (e->op) {
+    case OP_LEAF:   memmove(out, x, n * sizeof *out); break;
+
+    case OP_ADD:    k->add(out, x, y, n); break;
+    case OP_SUB:    k->sub(out, x, y, n); break;
+    case OP_MUL:    k->mul(out, x, y, n); break;
+    case OP_DIV:    for (size_t i = 0; i < n; i++) out[i] = x[i] / y[i]; break;
+    case OP_GT:     k->gt(out, x, y, n); break;
+    case OP_LT:     k->lt(out, x, y, n); break;
+    case OP_EQ:     k->eq(out, x, y, n); break;
+
+    case OP_ADD_S:  k->add_scalar(out, x, s, n); break;
+    case OP_SUB_S:  k->sub_scalar(out, x, s, n); break;
+    case OP_MUL_S:  k->mul_scalar(out, x, s, n); break;
+    case OP_DIV_S:  k->div_scalar(out, x, s, n); break;
+    case OP_GT_S:   k->gt_scalar(out, x, s, n); break;
+    case OP_LT_S:   k->lt_scalar(out, x, s, n); break;
+    case OP_EQ_S:   k->eq_scalar(out, x, s, n); break;
+
+    case OP_EXP:    vmath_exp(out, x, n); break;
+    case OP_LOGE:   vmath_log(out, x, n); break;
+    case OP_SQRT:   vmath_sqrt(out, x, n); break;
+    case OP_POW:    vmath_pow(out, x, n, s); break;
+    case OP_SIN:    vmath_sin(out, x, n); break;
+    case OP_COS:    vmath_cos(out, x, n); break;
+    case OP_TAN:    vmath_tan(out, x, n); break;
+    case OP_SINH:   vmath_sinh(out, x, n); break;
+    case OP_COSH:   vmath_cosh(out, x, n); break;
+    case OP_TANH:   vmath_tanh(out, x, n); break;
+    case OP_ABS:    for (size_t i = 0; i < n; i++) out[i] = fabs(x[i]); break;
+    }
+}
+
+int vec_eval_into(struct Vector *dst, const struct VecExpr *e)
+{
+    if (!e) {
+        if (!errno) errno = EINVAL;   /* keep what the failing builder set */
+        fprintf(stderr, "vec_eval_into error: expression was not built\n");
+        return -1;
+    }
+
+    if (!dst || (!dst->data && dst->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_eval_into error: vector pointer is NULL\n");
+        return -1;
+    }
+
+    if (dst->size != e->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_eval_into error: size mismatch (dst %zu, expression %zu)\n",
+                dst->size, e->size);
+        return -1;
+    }
+
+    struct VecGraph *graph = e->graph;
+    size_t count = e->id + 1;    /* later nodes cannot feed e */
+
+    /* nodes by id, then the ones e depends on: operands have lower ids, so
+       a single backward sweep finds them all */
+    struct VecExpr **nodes = malloc(count * sizeof *nodes);
+    unsigned char *live = calloc(count, 1);
+    size_t *slot = malloc(count * sizeof *slot);
+    if (!nodes || !live || !slot) {
+        free(nodes); free(live); free(slot);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_eval_into error: %s\n", strerror(errno));
+        return -1;
+    }
+
+    struct VecExpr *node = graph->first;
+    for (size_t i = 0; i < count; i++, node = node->next)
+        nodes[i] = node;
+
+    for (size_t i = count; i-- > 0;) {
+        if (i == e->id) live[i] = 1;
+        if (!live[i]) continue;
+        if (nodes[i]->a) live[nodes[i]->a->id] = 1;
+        if (nodes[i]->b) live[nodes[i]->b->id] = 1;
+    }
+
+    /* one scratch block per live interior node except the root, which
+       writes straight into dst */
+    size_t scratch = 0;
+    for (size_t i = 0; i < e->id; i++)
+        if (live[i] && nodes[i]->op != OP_LEAF) slot[i] = scratch++;
+
+    double *buf = NULL;
+    if (scratch > 0) {
+        buf = vec_aligned_alloc(scratch * EXPR_BLOCK * sizeof(double));
+        if (!buf) {
+            free(nodes); free(live); free(slot);
+            errno = ENOMEM;
+            fprintf(stderr, "vec_eval_into error: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+
+    const struct VecKernels *k = vec_kernels();
+
+    /* within a block every node reads its operands before the root writes,
+       and later blocks only read later elements, so dst may be a leaf */
+    for (size_t off = 0; off < e->size; off += EXPR_BLOCK) {
+        size_t n = e->size - off < EXPR_BLOCK ? e->size - off : EXPR_BLOCK;
+
+        for (size_t i = 0; i < count; i++) {
+            const struct VecExpr *cur = nodes[i];
+            if (!live[i] || (cur->op == OP_LEAF && i != e->id)) continue;
+
+            const double *x, *y = NULL;
+            if (cur->op == OP_LEAF) {
+                x = cur->leaf->data + off;
+            } else {
+                x = cur->a->op == OP_LEAF ? cur->a->leaf->data + off
+                                          : buf + slot[cur->a->id] * EXPR_BLOCK;
+                if (cur->b)
+                    y = cur->b->op == OP_LEAF ? cur->b->leaf->data + off
+                                              : buf + slot[cur->b->id] * EXPR_BLOCK;
+            }
+
+            double *out = (i == e->id) ? dst->data + off : buf + slot[i] * EXPR_BLOCK;
+            eval_block(k, cur, out, x, y, n);
+        }
+    }
+
+    vec_aligned_free(buf);
+    free(nodes);
+    free(live);
+    free(slot);
+    return 0;
+}
+
+struct Vector *vec_eval(const struct VecExpr *e)
+{
+    if (!e) {
+        if (!errno) errno = EINVAL;   /* keep what the failing builder set */
+        fprintf(stderr, "vec_eval error: expression was not built\n");
+        return NULL;
+    }
+
+    struct Vector *out = vec_alloc(e->size);
+    if (!out) return NULL;
+
+    if (vec_eval_into(out, e) != 0) {
+        dest_vector(out);
+        return NULL;
+    }
+
+    return out;
+}
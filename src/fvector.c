@@ -0,0 +1,1242 @@
+/* fvector.c */
+
+#include "libs.h"
+#include "fvector.h"
+
+/* same layout trick as struct VectorInline, used for arena allocations */
+struct FVectorInline {
+    struct FVector vec;
+    _Alignas(VEC_ALIGNMENT) float payload[];
+};
+
+#define FEPS 1e-6f   /* for floating equality, float counterpart of EPS */
+
+/* ===========================================
+                FVector creation
+   =========================================== */
+
+struct FVector *fvec_alloc(size_t size)
+{
+    if (size > (SIZE_MAX - sizeof(struct FVectorInline)) / sizeof(float)) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "fvec_alloc error: size overflows the address space (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    struct VecArena *arena = vec_arena_current();
+    if (arena) {
+        struct FVectorInline *block =
+            vec_arena_alloc_bytes(arena, sizeof(struct FVectorInline) + size * sizeof(float));
+        if (!block) {
+            errno = ENOMEM;
+            fprintf(stderr,
+                    "fvec_alloc error: failed to allocate from arena (%s)\n",
+                    strerror(errno));
+            return NULL;
+        }
+
+        block->vec.size = size;
+        block->vec.data = block->payload;
+        block->vec.storage = VEC_STORAGE_ARENA;
+        return &block->vec;
+    }
+
+    struct FVector *v = malloc(sizeof *v);
+    if (!v) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "fvec_alloc error: failed to allocate FVector struct (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    v->size = size;
+    v->storage = VEC_STORAGE_HEAP;
+    v->data = vec_aligned_alloc(size * sizeof(float));
+
+    if (!v->data) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "fvec_alloc error: failed to allocate data buffer (%s)\n",
+                strerror(errno));
+        free(v);
+        return NULL;
+    }
+
+    return v;
+}
+
+struct FVector *fvec_zeros(size_t size)
+{
+    struct FVector *v = fvec_alloc(size);
+    if (!v) return NULL;
+
+    memset(v->data, 0, size * sizeof(float));
+    return v;
+}
+
+struct FVector *fvec_scalar(size_t size, float scalar)
+{
+    struct FVector *v = fvec_alloc(size);
+    if (!v) return NULL;
+
+    for (size_t i = 0; i < size; i++)
+        v->data[i] = scalar;
+
+    return v;
+}
+
+struct FVector *fvec_ones(size_t size)
+{
+    return fvec_scalar(size, 1.0f);
+}
+
+struct FVector *fvec_arange(size_t size, float start, float step)
+{
+    struct FVector *v = fvec_alloc(size);
+    if (!v) return NULL;
+
+    /* start + i * step rather than repeated addition, which drifts in float */
+    for (size_t i = 0; i < size; i++)
+        v->data[i] = (float)((double)start + (double)step * (double)i);
+
+    return v;
+}
+
+struct FVector *fvec_linspace(size_t size, float start, float end)
+{
+    if (size == 0) return NULL;
+
+    struct FVector *v = fvec_alloc(size);
+    if (!v) return NULL;
+
+    if (size == 1) {
+        v->data[0] = start;
+        return v;
+    }
+
+    double step = ((double)end - (double)start) / ((double)size - 1);
+
+    for (size_t i = 0; i < size; i++)
+        v->data[i] = (float)((double)start + step * (double)i);
+
+    /* guarantee exact endpoint */
+    v->data[size - 1] = end;
+
+    return v;
+}
+
+struct FVector *fvec_from_array(const float *arr, size_t size)
+{
+    if (!arr) return NULL;
+
+    struct FVector *v = fvec_alloc(size);
+    if (!v) return NULL;
+
+    cblas_scopy((int)size, arr, 1, v->data, 1);
+
+    return v;
+}
+
+/* ===========================================
+                Destruction / Debug
+   =========================================== */
+
+void dest_fvector(struct FVector *vector)
+{
+    if (!vector) return;
+
+    /* arena vectors go away with vec_arena_reset / vec_arena_destroy */
+    if (vector->storage == VEC_STORAGE_ARENA) return;
+
+    vec_aligned_free(vector->data);
+    free(vector);
+}
+
+void print_fvector(const struct FVector *vector)
+{
+    if (!vector) return;
+
+    for (size_t i = 0; i < vector->size; i++)
+        printf("%f ", (double)vector->data[i]);
+    printf("\n");
+}
+
+/* ===========================================
+                Argument checks
+   =========================================== */
+
+static struct FVector *alloc_result(const char *fn, const struct FVector *v)
+{
+    if (!v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s: invalid vector pointer (%s)\n", fn, strerror(errno));
+        return NULL;
+    }
+
+    if (v->size == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s: vector size is zero (%s)\n", fn, strerror(errno));
+        return NULL;
+    }
+
+    struct FVector *out = fvec_alloc(v->size);
+    if (!out) {
+        errno = ENOMEM;
+        fprintf(stderr, "%s: failed to allocate result (%s)\n", fn, strerror(errno));
+        return NULL;
+    }
+
+    return out;
+}
+
+static int check_unary(const char *fn, const struct FVector *dst, const struct FVector *v)
+{
+    if (!dst || !v || !dst->data || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (v->size == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector size is zero\n", fn);
+        return -1;
+    }
+
+    if (dst->size != v->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (dst %zu, input %zu)\n",
+                fn, dst->size, v->size);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int check_binary(const char *fn, const struct FVector *dst,
+                        const struct FVector *a, const struct FVector *b)
+{
+    if (!b || !b->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (check_unary(fn, dst, a) != 0) return -1;
+
+    if (b->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (a %zu, b %zu)\n",
+                fn, a->size, b->size);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int check_input(const char *fn, const struct FVector *v)
+{
+    return check_unary(fn, v, v);
+}
+
+/* ===========================================
+                Precision conversion
+   =========================================== */
+
+int fvec_from_vec_into(struct FVector *dst, const struct Vector *src)
+{
+    if (!dst || !src || !dst->data || !src->data || dst->size != src->size) {
+        errno = EINVAL;
+        fprintf(stderr, "fvec_from_vec_into error: invalid or mismatched vectors\n");
+        return -1;
+    }
+
+    const double *x = src->data;
+    float *y = dst->data;
+    for (size_t i = 0; i < src->size; i++)
+        y[i] = (float)x[i];
+
+    return 0;
+}
+
+int vec_from_fvec_into(struct Vector *dst, const struct FVector *src)
+{
+    if (!dst || !src || !dst->data || !src->data || dst->size != src->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_from_fvec_into error: invalid or mismatched vectors\n");
+        return -1;
+    }
+
+    const float *x = src->data;
+    double *y = dst->data;
+    for (size_t i = 0; i < src->size; i++)
+        y[i] = (double)x[i];
+
+    return 0;
+}
+
+struct FVector *fvec_from_vec(const struct Vector *v)
+{
+    if (!v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "fvec_from_vec: invalid vector pointer (%s)\n", strerror(errno));
+        return NULL;
+    }
+
+    struct FVector *out = fvec_alloc(v->size);
+    if (!out) return NULL;
+
+    fvec_from_vec_into(out, v);
+    return out;
+}
+
+struct Vector *vec_from_fvec(const struct FVector *v)
+{
+    if (!v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_from_fvec: invalid vector pointer (%s)\n", strerror(errno));
+        return NULL;
+    }
+
+    struct Vector *out = vec_alloc(v->size);
+    if (!out) return NULL;
+
+    vec_from_fvec_into(out, v);
+    return out;
+}
+
+/* ===========================================
+                Aggregation
+   =========================================== */
+
+double fvec_aggr_sum(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return 0.0;
+
+    double total_sum = 0.0;
+    for (size_t i = 0; i < vector->size; i++)
+        total_sum += (double)vector->data[i];
+
+    return total_sum;
+}
+
+double fvec_aggr_mean(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return 0.0;
+
+    return fvec_aggr_sum(vector) / (double)vector->size;
+}
+
+float fvec_aggr_min(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return 0.0f;
+
+    float min_value = FLT_MAX;
+    for (size_t i = 0; i < vector->size; i++)
+        if (vector->data[i] < min_value) min_value = vector->data[i];
+
+    return min_value;
+}
+
+float fvec_aggr_max(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return 0.0f;
+
+    float max_value = -FLT_MAX;
+    for (size_t i = 0; i < vector->size; i++)
+        if (vector->data[i] > max_value) max_value = vector->data[i];
+
+    return max_value;
+}
+
+int fvec_aggr_argmin(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return -1;
+
+    size_t min_index = 0;
+    for (size_t i = 1; i < vector->size; i++)
+        if (vector->data[i] < vector->data[min_index]) min_index = i;
+
+    return (int)min_index;
+}
+
+int fvec_aggr_argmax(const struct FVector *vector)
+{
+    if (!vector || !vector->data || vector->size == 0) return -1;
+
+    size_t max_index = 0;
+    for (size_t i = 1; i < vector->size; i++)
+        if (vector->data[i] > vector->data[max_index]) max_index = i;
+
+    return (int)max_index;
+}
+
+/* ===========================================
+                Math kernels
+   =========================================== */
+
+enum FMathOp {
+    FMATH_POW,
+    FMATH_SQRT,
+    FMATH_CBRT,
+    FMATH_SIN,
+    FMATH_COS,
+    FMATH_TAN,
+    FMATH_ASIN,
+    FMATH_ACOS,
+    FMATH_ATAN,
+    FMATH_SINH,
+    FMATH_COSH,
+    FMATH_TANH,
+    FMATH_LOGE,
+    FMATH_LOG,
+    FMATH_EXP,
+    FMATH_FLOOR,
+    FMATH_CEIL,
+    FMATH_FMOD,
+    FMATH_TRUNC,
+    FMATH_ROUND,
+};
+
+/* one switch per call, each case a tight loop over libm's float functions */
+static void fmath_kernel(float *y, const float *x, size_t n, enum FMathOp op, float p)
+{
+    switch (op) {
+    case FMATH_POW: for (size_t i = 0; i < n; i++) y[i] = powf(x[i], p); break;
+    case FMATH_SQRT: for (size_t i = 0; i < n; i++) y[i] = sqrtf(x[i]); break;
+    case FMATH_CBRT: for (size_t i = 0; i < n; i++) y[i] = cbrtf(x[i]); break;
+    case FMATH_SIN: for (size_t i = 0; i < n; i++) y[i] = sinf(x[i]); break;
+    case FMATH_COS: for (size_t i = 0; i < n; i++) y[i] = cosf(x[i]); break;
+    case FMATH_TAN: for (size_t i = 0; i < n; i++) y[i] = tanf(x[i]); break;
+    case FMATH_ASIN: for (size_t i = 0; i < n; i++) y[i] = asinf(x[i]); break;
+    case FMATH_ACOS: for (size_t i = 0; i < n; i++) y[i] = acosf(x[i]); break;
+    case FMATH_ATAN: for (size_t i = 0; i < n; i++) y[i] = atanf(x[i]); break;
+    case FMATH_SINH: for (size_t i = 0; i < n; i++) y[i] = sinhf(x[i]); break;
+    case FMATH_COSH: for (size_t i = 0; i < n; i++) y[i] = coshf(x[i]); break;
+    case FMATH_TANH: for (size_t i = 0; i < n; i++) y[i] = tanhf(x[i]); break;
+    case FMATH_LOGE: for (size_t i = 0; i < n; i++) y[i] = logf(x[i]); break;
+    case FMATH_LOG: for (size_t i = 0; i < n; i++) y[i] = logf(x[i]) / p; break;
+    case FMATH_EXP: for (size_t i = 0; i < n; i++) y[i] = expf(x[i]); break;
+    case FMATH_FLOOR: for (size_t i = 0; i < n; i++) y[i] = floorf(x[i]); break;
+    case FMATH_CEIL: for (size_t i = 0; i < n; i++) y[i] = ceilf(x[i]); break;
+    case FMATH_FMOD: for (size_t i = 0; i < n; i++) y[i] = fmodf(x[i], p); break;
+    case FMATH_TRUNC: for (size_t i = 0; i < n; i++) y[i] = truncf(x[i]); break;
+    case FMATH_ROUND: for (size_t i = 0; i < n; i++) y[i] = roundf(x[i]); break;
+    }
+}
+
+static int fmath_into(const char *fn, struct FVector *dst, const struct FVector *v,
+                      enum FMathOp op, float p)
+{
+    if (check_unary(fn, dst, v) != 0) return -1;
+
+    if (op == FMATH_LOG) {
+        if (p <= 1.0f) {
+            errno = EINVAL;
+            fprintf(stderr, "%s error: base must be greater than 1\n", fn);
+            return -1;
+        }
+        p = logf(p);
+    }
+
+    if (op == FMATH_FMOD && p == 0.0f) {
+        errno = EDOM;
+        fprintf(stderr, "%s error: divisor is zero\n", fn);
+        return -1;
+    }
+
+    fmath_kernel(dst->data, v->data, v->size, op, p);
+    return 0;
+}
+
+static struct FVector *fmath_new(const char *fn, const struct FVector *v, enum FMathOp op, float p)
+{
+    struct FVector *out = alloc_result(fn, v);
+    if (!out) return NULL;
+
+    if (fmath_into(fn, out, v, op, p) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+/* ===========================================
+                Math (out of place / into / inplace)
+   =========================================== */
+
+struct FVector *fvec_math_pow(const struct FVector *vector, float power)
+{
+    return fmath_new("fvec_math_pow", vector, FMATH_POW, power);
+}
+
+int fvec_math_pow_into(struct FVector *dst, const struct FVector *vector, float power)
+{
+    return fmath_into("fvec_math_pow_into", dst, vector, FMATH_POW, power);
+}
+
+int fvec_math_pow_inplace(struct FVector *vector, float power)
+{
+    return fmath_into("fvec_math_pow_inplace", vector, vector, FMATH_POW, power);
+}
+
+struct FVector *fvec_math_sqrt(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_sqrt", vector, FMATH_SQRT, 0.0f);
+}
+
+int fvec_math_sqrt_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_sqrt_into", dst, vector, FMATH_SQRT, 0.0f);
+}
+
+int fvec_math_sqrt_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_sqrt_inplace", vector, vector, FMATH_SQRT, 0.0f);
+}
+
+struct FVector *fvec_math_cbrt(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_cbrt", vector, FMATH_CBRT, 0.0f);
+}
+
+int fvec_math_cbrt_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_cbrt_into", dst, vector, FMATH_CBRT, 0.0f);
+}
+
+int fvec_math_cbrt_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_cbrt_inplace", vector, vector, FMATH_CBRT, 0.0f);
+}
+
+struct FVector *fvec_math_sin(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_sin", vector, FMATH_SIN, 0.0f);
+}
+
+int fvec_math_sin_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_sin_into", dst, vector, FMATH_SIN, 0.0f);
+}
+
+int fvec_math_sin_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_sin_inplace", vector, vector, FMATH_SIN, 0.0f);
+}
+
+struct FVector *fvec_math_cos(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_cos", vector, FMATH_COS, 0.0f);
+}
+
+int fvec_math_cos_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_cos_into", dst, vector, FMATH_COS, 0.0f);
+}
+
+int fvec_math_cos_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_cos_inplace", vector, vector, FMATH_COS, 0.0f);
+}
+
+struct FVector *fvec_math_tan(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_tan", vector, FMATH_TAN, 0.0f);
+}
+
+int fvec_math_tan_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_tan_into", dst, vector, FMATH_TAN, 0.0f);
+}
+
+int fvec_math_tan_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_tan_inplace", vector, vector, FMATH_TAN, 0.0f);
+}
+
+struct FVector *fvec_math_asin(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_asin", vector, FMATH_ASIN, 0.0f);
+}
+
+int fvec_math_asin_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_asin_into", dst, vector, FMATH_ASIN, 0.0f);
+}
+
+int fvec_math_asin_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_asin_inplace", vector, vector, FMATH_ASIN, 0.0f);
+}
+
+struct FVector *fvec_math_acos(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_acos", vector, FMATH_ACOS, 0.0f);
+}
+
+int fvec_math_acos_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_acos_into", dst, vector, FMATH_ACOS, 0.0f);
+}
+
+int fvec_math_acos_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_acos_inplace", vector, vector, FMATH_ACOS, 0.0f);
+}
+
+struct FVector *fvec_math_atan(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_atan", vector, FMATH_ATAN, 0.0f);
+}
+
+int fvec_math_atan_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_atan_into", dst, vector, FMATH_ATAN, 0.0f);
+}
+
+int fvec_math_atan_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_atan_inplace", vector, vector, FMATH_ATAN, 0.0f);
+}
+
+struct FVector *fvec_math_sinh(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_sinh", vector, FMATH_SINH, 0.0f);
+}
+
+int fvec_math_sinh_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_sinh_into", dst, vector, FMATH_SINH, 0.0f);
+}
+
+int fvec_math_sinh_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_sinh_inplace", vector, vector, FMATH_SINH, 0.0f);
+}
+
+struct FVector *fvec_math_cosh(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_cosh", vector, FMATH_COSH, 0.0f);
+}
+
+int fvec_math_cosh_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_cosh_into", dst, vector, FMATH_COSH, 0.0f);
+}
+
+int fvec_math_cosh_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_cosh_inplace", vector, vector, FMATH_COSH, 0.0f);
+}
+
+struct FVector *fvec_math_tanh(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_tanh", vector, FMATH_TANH, 0.0f);
+}
+
+int fvec_math_tanh_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_tanh_into", dst, vector, FMATH_TANH, 0.0f);
+}
+
+int fvec_math_tanh_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_tanh_inplace", vector, vector, FMATH_TANH, 0.0f);
+}
+
+struct FVector *fvec_math_loge(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_loge", vector, FMATH_LOGE, 0.0f);
+}
+
+int fvec_math_loge_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_loge_into", dst, vector, FMATH_LOGE, 0.0f);
+}
+
+int fvec_math_loge_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_loge_inplace", vector, vector, FMATH_LOGE, 0.0f);
+}
+
+struct FVector *fvec_math_log(const struct FVector *vector, float base)
+{
+    return fmath_new("fvec_math_log", vector, FMATH_LOG, base);
+}
+
+int fvec_math_log_into(struct FVector *dst, const struct FVector *vector, float base)
+{
+    return fmath_into("fvec_math_log_into", dst, vector, FMATH_LOG, base);
+}
+
+int fvec_math_log_inplace(struct FVector *vector, float base)
+{
+    return fmath_into("fvec_math_log_inplace", vector, vector, FMATH_LOG, base);
+}
+
+struct FVector *fvec_math_exp(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_exp", vector, FMATH_EXP, 0.0f);
+}
+
+int fvec_math_exp_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_exp_into", dst, vector, FMATH_EXP, 0.0f);
+}
+
+int fvec_math_exp_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_exp_inplace", vector, vector, FMATH_EXP, 0.0f);
+}
+
+struct FVector *fvec_math_floor(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_floor", vector, FMATH_FLOOR, 0.0f);
+}
+
+int fvec_math_floor_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_floor_into", dst, vector, FMATH_FLOOR, 0.0f);
+}
+
+int fvec_math_floor_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_floor_inplace", vector, vector, FMATH_FLOOR, 0.0f);
+}
+
+struct FVector *fvec_math_ceil(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_ceil", vector, FMATH_CEIL, 0.0f);
+}
+
+int fvec_math_ceil_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_ceil_into", dst, vector, FMATH_CEIL, 0.0f);
+}
+
+int fvec_math_ceil_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_ceil_inplace", vector, vector, FMATH_CEIL, 0.0f);
+}
+
+struct FVector *fvec_math_fmod(const struct FVector *vector, float divisor)
+{
+    return fmath_new("fvec_math_fmod", vector, FMATH_FMOD, divisor);
+}
+
+int fvec_math_fmod_into(struct FVector *dst, const struct FVector *vector, float divisor)
+{
+    return fmath_into("fvec_math_fmod_into", dst, vector, FMATH_FMOD, divisor);
+}
+
+int fvec_math_fmod_inplace(struct FVector *vector, float divisor)
+{
+    return fmath_into("fvec_math_fmod_inplace", vector, vector, FMATH_FMOD, divisor);
+}
+
+struct FVector *fvec_math_trunc(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_trunc", vector, FMATH_TRUNC, 0.0f);
+}
+
+int fvec_math_trunc_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_trunc_into", dst, vector, FMATH_TRUNC, 0.0f);
+}
+
+int fvec_math_trunc_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_trunc_inplace", vector, vector, FMATH_TRUNC, 0.0f);
+}
+
+struct FVector *fvec_math_round(const struct FVector *vector)
+{
+    return fmath_new("fvec_math_round", vector, FMATH_ROUND, 0.0f);
+}
+
+int fvec_math_round_into(struct FVector *dst, const struct FVector *vector)
+{
+    return fmath_into("fvec_math_round_into", dst, vector, FMATH_ROUND, 0.0f);
+}
+
+int fvec_math_round_inplace(struct FVector *vector)
+{
+    return fmath_into("fvec_math_round_inplace", vector, vector, FMATH_ROUND, 0.0f);
+}
+
+/* ===========================================
+                Arithmetic
+   =========================================== */
+
+int fvec_add_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_add_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = a->data[i] + b->data[i];
+
+    return 0;
+}
+
+struct FVector *fvec_add(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_add", a);
+    if (!out) return NULL;
+
+    if (fvec_add_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_sub_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_sub_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = a->data[i] - b->data[i];
+
+    return 0;
+}
+
+struct FVector *fvec_sub(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_sub", a);
+    if (!out) return NULL;
+
+    if (fvec_sub_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_mul_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_mul_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = a->data[i] * b->data[i];
+
+    return 0;
+}
+
+struct FVector *fvec_mul(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_mul", a);
+    if (!out) return NULL;
+
+    if (fvec_mul_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_mul_inplace(struct FVector *a, const struct FVector *b)
+{
+    return fvec_mul_into(a, a, b);
+}
+
+/* Scalar Functions */
+
+int fvec_add_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_add_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = v->data[i] + s;
+
+    return 0;
+}
+
+struct FVector *fvec_add_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_add_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_add_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_add_scalar_inplace(struct FVector *v, float s)
+{
+    return fvec_add_scalar_into(v, v, s);
+}
+
+int fvec_sub_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_sub_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = v->data[i] - s;
+
+    return 0;
+}
+
+struct FVector *fvec_sub_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_sub_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_sub_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_sub_scalar_inplace(struct FVector *v, float s)
+{
+    return fvec_sub_scalar_into(v, v, s);
+}
+
+int fvec_mul_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_mul_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = v->data[i] * s;
+
+    return 0;
+}
+
+struct FVector *fvec_mul_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_mul_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_mul_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_mul_scalar_inplace(struct FVector *v, float s)
+{
+    return fvec_mul_scalar_into(v, v, s);
+}
+
+int fvec_div_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_div_scalar_into", dst, v) != 0) return -1;
+
+    if (s == 0.0f) {
+        errno = ERANGE;
+        fprintf(stderr, "fvec_div_scalar_into error: division by zero scalar\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = v->data[i] / s;
+
+    return 0;
+}
+
+struct FVector *fvec_div_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_div_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_div_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_div_scalar_inplace(struct FVector *v, float s)
+{
+    return fvec_div_scalar_into(v, v, s);
+}
+
+/* ===========================================
+                BLAS Level-1
+   =========================================== */
+
+float fvec_dot(const struct FVector *a, const struct FVector *b)
+{
+    if (!a || !b || !a->data || !b->data) return 0.0f;
+    if (a->size != b->size) return 0.0f;
+
+    return cblas_sdot((int)a->size, a->data, 1, b->data, 1);
+}
+
+int fvec_copy(struct FVector *dest, const struct FVector *src)
+{
+    if (!dest || !src || !dest->data || !src->data) return -1;
+    if (dest->size != src->size) return -1;
+
+    cblas_scopy((int)src->size, src->data, 1, dest->data, 1);
+    return 0;
+}
+
+int fvec_scale_inplace(struct FVector *v, float scalar)
+{
+    if (!v || !v->data) return -1;
+
+    cblas_sscal((int)v->size, scalar, v->data, 1);
+    return 0;
+}
+
+int fvec_axpy_inplace(struct FVector *y, const struct FVector *x, float a)
+{
+    /* Y[i] = alpha * X[i] + Y[i] */
+    if (!y || !x || !y->data || !x->data) return -1;
+    if (y->size != x->size) return -1;
+
+    cblas_saxpy((int)y->size, a, x->data, 1, y->data, 1);
+    return 0;
+}
+
+float fvec_norm2(const struct FVector *v)
+{
+    if (!v || !v->data) return 0.0f;
+
+    return cblas_snrm2((int)v->size, v->data, 1);
+}
+
+float fvec_asum(const struct FVector *v)
+{
+    if (!v || !v->data) return 0.0f;
+
+    return cblas_sasum((int)v->size, v->data, 1);
+}
+
+int fvec_iamax(const struct FVector *v)
+{
+    if (!v || !v->data) return -1;
+
+    return (int)cblas_isamax((int)v->size, v->data, 1);
+}
+
+/* ===========================================
+                Statistical functions
+   =========================================== */
+
+double fvec_var(const struct FVector *v)
+{
+    if (check_input("fvec_var", v) != 0) return -1;
+
+    double mean = fvec_aggr_mean(v);
+
+    double var = 0.0;
+    for (size_t i = 0; i < v->size; i++) {
+        double diff = (double)v->data[i] - mean;
+        var += diff * diff;
+    }
+
+    return var / (double)v->size;
+}
+
+double fvec_std(const struct FVector *v)
+{
+    return sqrt(fvec_var(v));
+}
+
+double fvec_sum_of_squares(const struct FVector *v)
+{
+    if (check_input("fvec_sum_of_squares", v) != 0) return -1;
+
+    double sum = 0.0;
+    for (size_t i = 0; i < v->size; i++)
+        sum += (double)v->data[i] * (double)v->data[i];
+
+    return sum;
+}
+
+double fvec_cov(const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_cov", a, a, b) != 0) return -1;
+
+    double mean_a = fvec_aggr_mean(a);
+    double mean_b = fvec_aggr_mean(b);
+
+    double cov = 0.0;
+    for (size_t i = 0; i < a->size; i++)
+        cov += ((double)a->data[i] - mean_a) * ((double)b->data[i] - mean_b);
+
+    return cov / (double)a->size;
+}
+
+double fvec_corr(const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_corr", a, a, b) != 0) return -1;
+
+    double mean_a = fvec_aggr_mean(a);
+    double mean_b = fvec_aggr_mean(b);
+
+    double cov = 0.0, var_a = 0.0, var_b = 0.0;
+    for (size_t i = 0; i < a->size; i++) {
+        double da = (double)a->data[i] - mean_a;
+        double db = (double)b->data[i] - mean_b;
+
+        cov   += da * db;
+        var_a += da * da;
+        var_b += db * db;
+    }
+
+    if (var_a == 0.0 || var_b == 0.0)
+        return NAN;
+
+    return cov / (sqrt(var_a) * sqrt(var_b));
+}
+
+/* ===========================================
+                Comparison Functions
+   =========================================== */
+
+int fvec_gt_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_gt_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = (a->data[i] > b->data[i]) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+int fvec_gt_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_gt_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = (v->data[i] > s) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+struct FVector *fvec_gt(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_gt", a);
+    if (!out) return NULL;
+
+    if (fvec_gt_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+struct FVector *fvec_gt_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_gt_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_gt_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_lt_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_lt_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = (a->data[i] < b->data[i]) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+int fvec_lt_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_lt_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = (v->data[i] < s) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+struct FVector *fvec_lt(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_lt", a);
+    if (!out) return NULL;
+
+    if (fvec_lt_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+struct FVector *fvec_lt_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_lt_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_lt_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+int fvec_eq_into(struct FVector *dst, const struct FVector *a, const struct FVector *b)
+{
+    if (check_binary("fvec_eq_into", dst, a, b) != 0) return -1;
+
+    for (size_t i = 0; i < a->size; i++)
+        dst->data[i] = (fabsf(a->data[i] - b->data[i]) < FEPS) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+int fvec_eq_scalar_into(struct FVector *dst, const struct FVector *v, float s)
+{
+    if (check_unary("fvec_eq_scalar_into", dst, v) != 0) return -1;
+
+    for (size_t i = 0; i < v->size; i++)
+        dst->data[i] = (fabsf(v->data[i] - s) < FEPS) ? 1.0f : 0.0f;
+
+    return 0;
+}
+
+struct FVector *fvec_eq(const struct FVector *a, const struct FVector *b)
+{
+    struct FVector *out = alloc_result("fvec_eq", a);
+    if (!out) return NULL;
+
+    if (fvec_eq_into(out, a, b) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
+
+struct FVector *fvec_eq_scalar(const struct FVector *v, float s)
+{
+    struct FVector *out = alloc_result("fvec_eq_scalar", v);
+    if (!out) return NULL;
+
+    if (fvec_eq_scalar_into(out, v, s) != 0) {
+        dest_fvector(out);
+        return NULL;
+    }
+
+    return out;
+}
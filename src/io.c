@@ -0,0 +1,319 @@
+/* io.c */
+
+/* fileno and fsync are POSIX, hidden by -std=c11 */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "libs.h"
+#include "vector.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(struct VecFileHeader) == VEC_FILE_HEADER_SIZE,
+               "VecFileHeader must stay 64 bytes");
+
+static const char vec_file_magic[8] = { 'A', 'X', 'P', 'Y', 'V', 'E', 'C', '\0' };
+
+#define VEC_BYTE_ORDER         0x01020304u
+#define VEC_BYTE_ORDER_SWAPPED 0x04030201u
+
+/* ===========================================
+                Checksum
+   =========================================== */
+
+/* FNV-1a over 64-bit words, four interleaved lanes so the multiplies
+   overlap, lanes folded in order at the end. Trailing bytes (never present
+   for double payloads) are folded one at a time into lane 0. */
+#define FNV_OFFSET 0xcbf29ce484222325ull
+#define FNV_PRIME  0x100000001b3ull
+
+uint64_t vec_checksum(const void *data, size_t bytes)
+{
+    const unsigned char *p = data;
+    uint64_t lane[4] = { FNV_OFFSET, FNV_OFFSET ^ 1, FNV_OFFSET ^ 2, FNV_OFFSET ^ 3 };
+    size_t words = bytes / sizeof(uint64_t);
+    size_t i = 0;
+
+    for (; i + 4 <= words; i += 4) {
+        for (int k = 0; k < 4; k++) {
+            uint64_t w;
+            memcpy(&w, p + (i + (size_t)k) * sizeof w, sizeof w);
+            lane[k] = (lane[k] ^ w) * FNV_PRIME;
+        }
+    }
+
+    for (; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * sizeof w, sizeof w);
+        lane[i & 3] = (lane[i & 3] ^ w) * FNV_PRIME;
+    }
+
+    for (size_t b = words * sizeof(uint64_t); b < bytes; b++)
+        lane[0] = (lane[0] ^ p[b]) * FNV_PRIME;
+
+    uint64_t h = FNV_OFFSET;
+    for (int k = 0; k < 4; k++)
+        h = (h ^ lane[k]) * FNV_PRIME;
+
+    return h;
+}
+
+/* ===========================================
+                Save
+   =========================================== */
+
+/* Pushes a written file to stable storage before it is renamed over the
+   target; without it the rename can reach the disk ahead of the data */
+static int sync_file(FILE *f)
+{
+    if (fflush(f) != 0) return -1;
+#if !defined(_WIN32)
+    if (fsync(fileno(f)) != 0) return -1;
+#endif
+    return 0;
+}
+
+/* Makes the rename itself durable by syncing the directory entry */
+static int sync_parent_dir(const char *path)
+{
+#if !defined(_WIN32)
+    const char *slash = strrchr(path, '/');
+    char *dir;
+
+    if (!slash) {
+        dir = strdup(".");
+    } else {
+        size_t len = slash == path ? 1 : (size_t)(slash - path);
+        dir = malloc(len + 1);
+        if (dir) {
+            memcpy(dir, path, len);
+            dir[len] = '\0';
+        }
+    }
+    if (!dir) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0) return -1;
+
+    int rc = fsync(fd);
+    int err = errno;
+    close(fd);
+    errno = err;
+    return rc;
+#else
+    (void)path;
+    return 0;
+#endif
+}
+
+int vec_save(const struct Vector *v, const char *path, int flags)
+{
+    if (!v || (!v->data && v->size > 0) || !path) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_save error: invalid vector or path\n");
+        return -1;
+    }
+
+    struct VecFileHeader hdr;
+    memset(&hdr, 0, sizeof hdr);
+    memcpy(hdr.magic, vec_file_magic, sizeof hdr.magic);
+    hdr.version = VEC_FILE_VERSION;
+    hdr.dtype = VEC_DTYPE_F64;
+    hdr.count = (uint64_t)v->size;
+    hdr.data_offset = VEC_FILE_HEADER_SIZE;
+    hdr.alignment = VEC_ALIGNMENT;
+    hdr.byte_order = VEC_BYTE_ORDER;
+
+    if (flags & VEC_SAVE_CHECKSUM) {
+        hdr.flags |= VEC_FILE_HAS_CHECKSUM;
+        hdr.checksum = vec_checksum(v->data, v->size * sizeof(double));
+    }
+
+    /* write next to the target, sync, then rename and sync the directory,
+       so a crash mid-checkpoint never leaves a truncated file under the
+       real name */
+    size_t len = strlen(path);
+    char *tmp = malloc(len + sizeof ".tmp");
+    if (!tmp) {
+        errno = ENOMEM;
+        fprintf(stderr, "vec_save error: %s\n", strerror(errno));
+        return -1;
+    }
+    memcpy(tmp, path, len);
+    memcpy(tmp + len, ".tmp", sizeof ".tmp");
+
+    FILE *f = fopen(tmp, "wb");
+    if (!f) {
+        fprintf(stderr, "vec_save error: cannot open %s (%s)\n", tmp, strerror(errno));
+        free(tmp);
+        return -1;
+    }
+
+    int ok = fwrite(&hdr, sizeof hdr, 1, f) == 1;
+    if (ok && v->size > 0)
+        ok = fwrite(v->data, sizeof(double), v->size, f) == v->size;
+
+    if (ok && sync_file(f) != 0) ok = 0;
+    if (fclose(f) != 0) ok = 0;
+
+    if (!ok || rename(tmp, path) != 0) {
+        int err = errno;
+        fprintf(stderr, "vec_save error: failed to write %s (%s)\n", path, strerror(err));
+        remove(tmp);
+        free(tmp);
+        errno = err;
+        return -1;
+    }
+
+    free(tmp);
+
+    if (sync_parent_dir(path) != 0) {
+        fprintf(stderr, "vec_save error: failed to sync the directory of %s (%s)\n",
+                path, strerror(errno));
+        return -1;
+    }
+
+    return 0;
+}
+
+/* ===========================================
+                Load
+   =========================================== */
+
+static int read_header(const char *fn, const char *path, struct VecFileHeader *hdr)
+{
+    if (!path || !hdr) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: NULL path or header\n", fn);
+        return -1;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s error: cannot open %s (%s)\n", fn, path, strerror(errno));
+        return -1;
+    }
+
+    size_t got = fread(hdr, sizeof *hdr, 1, f);
+    fclose(f);
+
+    if (got != 1 || memcmp(hdr->magic, vec_file_magic, sizeof hdr->magic) != 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: %s is not an axpy vector file\n", fn, path);
+        return -1;
+    }
+
+    if (hdr->byte_order != VEC_BYTE_ORDER) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: %s was written with %s byte order\n", fn, path,
+                hdr->byte_order == VEC_BYTE_ORDER_SWAPPED ? "the opposite" : "an unknown");
+        return -1;
+    }
+
+    if (hdr->version == 0 || hdr->version > VEC_FILE_VERSION) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: %s has format version %u, known are 1 to %u\n",
+                fn, path, (unsigned)hdr->version, (unsigned)VEC_FILE_VERSION);
+        return -1;
+    }
+
+    if (hdr->data_offset < VEC_FILE_HEADER_SIZE || hdr->data_offset % sizeof(double) != 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: %s has a corrupt payload offset\n", fn, path);
+        return -1;
+    }
+
+    return 0;
+}
+
+int vec_read_header(const char *path, struct VecFileHeader *hdr)
+{
+    return read_header("vec_read_header", path, hdr);
+}
+
+/* heap copy, for VEC_LOAD_COPY and platforms without mappings */
+static struct Vector *load_copy(const char *path, const struct VecFileHeader *hdr)
+{
+    struct Vector *v = vec_alloc((size_t)hdr->count);
+    if (!v) return NULL;
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "vec_load error: cannot open %s (%s)\n", path, strerror(errno));
+        dest_vector(v);
+        return NULL;
+    }
+
+    int ok = fseek(f, (long)hdr->data_offset, SEEK_SET) == 0 &&
+             fread(v->data, sizeof(double), v->size, f) == v->size;
+    fclose(f);
+
+    if (!ok) {
+        errno = EIO;
+        fprintf(stderr, "vec_load error: %s is truncated\n", path);
+        dest_vector(v);
+        return NULL;
+    }
+
+    return v;
+}
+
+struct Vector *vec_load(const char *path, int mode)
+{
+    struct VecFileHeader hdr;
+    if (read_header("vec_load", path, &hdr) != 0) return NULL;
+
+    if ((mode & VEC_LOAD_VERIFY) && !(hdr.flags & VEC_FILE_HAS_CHECKSUM)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_load error: verify requested but %s was saved without a checksum\n",
+                path);
+        return NULL;
+    }
+
+    if (hdr.dtype != VEC_DTYPE_F64) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_load error: %s does not hold doubles (dtype %u)\n",
+                path, (unsigned)hdr.dtype);
+        return NULL;
+    }
+
+    if (hdr.count > SIZE_MAX / sizeof(double)) {
+        errno = EFBIG;
+        fprintf(stderr, "vec_load error: %s is too large for this address space\n", path);
+        return NULL;
+    }
+
+    struct Vector *v;
+
+    if (hdr.count == 0) {
+        v = vec_alloc(0);
+    } else if (mode & VEC_LOAD_COPY) {
+        v = load_copy(path, &hdr);
+    } else {
+        /* the header keeps the payload at an aligned offset, so it can be
+           mapped in place without parsing anything past the first 64 bytes */
+        v = vec_mmap_open_range(path, mode & ~(VEC_LOAD_COPY | VEC_LOAD_VERIFY),
+                                (size_t)hdr.data_offset, (size_t)hdr.count);
+        if (!v && errno == ENOSYS) v = load_copy(path, &hdr);
+    }
+
+    if (!v) return NULL;
+
+    if ((mode & VEC_LOAD_VERIFY) &&
+        vec_checksum(v->data, v->size * sizeof(double)) != hdr.checksum) {
+        errno = EIO;
+        fprintf(stderr, "vec_load error: checksum mismatch in %s\n", path);
+        dest_vector(v);
+        return NULL;
+    }
+
+    return v;
+}
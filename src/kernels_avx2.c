@@ -0,0 +1,79 @@
+/* kernels_avx2.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+/* only AVX instructions are needed for doubles, but the level is gated on
+   AVX2 so it matches the machines people mean by it; no FMA, so products
+   round the same way as at the lower levels */
+#define KERNEL_TARGET __attribute__((target("avx2")))
+#define KN(name) avx2_##name
+#define KTABLE   vec_kernels_avx2
+#define KISA     VEC_ISA_AVX2
+
+#define VW 4
+typedef __m256d vtype;
+
+#define V_LOAD(p)      _mm256_loadu_pd(p)
+#define V_STORE(p, v)  _mm256_storeu_pd(p, v)
+#define V_SET1(s)      _mm256_set1_pd(s)
+#define V_ADD(a, b)    _mm256_add_pd(a, b)
+#define V_SUB(a, b)    _mm256_sub_pd(a, b)
+#define V_MUL(a, b)    _mm256_mul_pd(a, b)
+#define V_DIV(a, b)    _mm256_div_pd(a, b)
+#define V_MIN(x, acc)  _mm256_min_pd(x, acc)
+#define V_MAX(x, acc)  _mm256_max_pd(x, acc)
+#define V_ABS(a)       _mm256_andnot_pd(_mm256_set1_pd(-0.0), a)
+#define V_SQRT(a)      _mm256_sqrt_pd(a)
+#define V_GT01(a, b)   _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ), _mm256_set1_pd(1.0))
+#define V_LT01(a, b)   _mm256_and_pd(_mm256_cmp_pd(a, b, _CMP_LT_OQ), _mm256_set1_pd(1.0))
+
+typedef __m256d mtype;
+
+#define M_LT(a, b)       _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define M_GT(a, b)       _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+#define M_ORD(a)         _mm256_cmp_pd(a, a, _CMP_ORD_Q)
+#define M_ANY(m)         _mm256_movemask_pd(m)
+#define M_NZ(a)          _mm256_cmp_pd(a, _mm256_setzero_pd(), _CMP_NEQ_UQ)
+
+/* 32-bit lane pairs that move the selected doubles of a 4-bit mask to the
+   front, for vpermps; the unused tail lanes are don't-care */
+static const int32_t compress_perm[16][8] = {
+    { 0, 0, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 0, 0, 0, 0, 0, 0 },
+    { 2, 3, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 0, 0, 0, 0 },
+    { 4, 5, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 4, 5, 0, 0, 0, 0 },
+    { 2, 3, 4, 5, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 4, 5, 0, 0 },
+    { 6, 7, 0, 0, 0, 0, 0, 0 },
+    { 0, 1, 6, 7, 0, 0, 0, 0 },
+    { 2, 3, 6, 7, 0, 0, 0, 0 },
+    { 0, 1, 2, 3, 6, 7, 0, 0 },
+    { 4, 5, 6, 7, 0, 0, 0, 0 },
+    { 0, 1, 4, 5, 6, 7, 0, 0 },
+    { 2, 3, 4, 5, 6, 7, 0, 0 },
+    { 0, 1, 2, 3, 4, 5, 6, 7 },
+};
+
+static KERNEL_TARGET inline size_t avx2_compress_lanes(double *p, __m256d v, __m256d m)
+{
+    int bits = _mm256_movemask_pd(m);
+    __m256i idx = _mm256_loadu_si256((const __m256i *)compress_perm[bits]);
+    _mm256_storeu_pd(p, _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(v), idx)));
+    return (size_t)__builtin_popcount((unsigned)bits);
+}
+
+#define V_COMPRESS(p, v, m) avx2_compress_lanes(p, v, m)
+#define V_BLEND(m, a, b) _mm256_blendv_pd(b, a, m)
+#define V_MASKZ(m, a)    _mm256_and_pd(m, a)
+
+#include "kernels_impl.h"
+
+#endif
@@ -0,0 +1,51 @@
+/* kernels_avx512.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+/* AVX-512F only; comparisons land in mask registers and are turned into
+   1.0 / 0.0 with a zero-masked move */
+#define KERNEL_TARGET __attribute__((target("avx512f")))
+#define KN(name) avx512_##name
+#define KTABLE   vec_kernels_avx512
+#define KISA     VEC_ISA_AVX512
+
+#define VW 8
+typedef __m512d vtype;
+
+#define V_LOAD(p)      _mm512_loadu_pd(p)
+#define V_STORE(p, v)  _mm512_storeu_pd(p, v)
+#define V_SET1(s)      _mm512_set1_pd(s)
+#define V_ADD(a, b)    _mm512_add_pd(a, b)
+#define V_SUB(a, b)    _mm512_sub_pd(a, b)
+#define V_MUL(a, b)    _mm512_mul_pd(a, b)
+#define V_DIV(a, b)    _mm512_div_pd(a, b)
+#define V_MIN(x, acc)  _mm512_min_pd(x, acc)
+#define V_MAX(x, acc)  _mm512_max_pd(x, acc)
+#define V_ABS(a)       _mm512_abs_pd(a)
+#define V_SQRT(a)      _mm512_sqrt_pd(a)
+#define V_GT01(a, b)   _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), _mm512_set1_pd(1.0))
+#define V_LT01(a, b)   _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_LT_OQ), _mm512_set1_pd(1.0))
+
+typedef __mmask8 mtype;
+
+#define M_LT(a, b)       _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ)
+#define M_GT(a, b)       _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ)
+#define M_ORD(a)         _mm512_cmp_pd_mask(a, a, _CMP_ORD_Q)
+#define M_ANY(m)         ((int)(m))
+#define M_NZ(a)          _mm512_cmp_pd_mask(a, _mm512_setzero_pd(), _CMP_NEQ_UQ)
+
+/* compress-store writes only the selected lanes, packed */
+#define V_COMPRESS(p, v, m) \
+    (_mm512_mask_compressstoreu_pd(p, m, v), (size_t)__builtin_popcount((unsigned)(m)))
+#define V_BLEND(m, a, b) _mm512_mask_blend_pd(m, b, a)
+#define V_MASKZ(m, a)    _mm512_maskz_mov_pd(m, a)
+
+#include "kernels_impl.h"
+
+#endif
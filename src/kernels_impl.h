@@ -0,0 +1,424 @@
+/* kernels_impl.h */
+
+/* Body of one dispatch level, included once by each kernels_<isa>.c after
+   it defines:
+
+     KERNEL_TARGET      function attribute enabling the instruction set
+     KN(name)           per-level name of a kernel
+     KTABLE / KISA      name of the exported table and its VEC_ISA_* level
+     VW, vtype          lanes per register and the register type
+     V_LOAD V_STORE V_SET1 V_ADD V_SUB V_MUL V_DIV V_MIN V_MAX V_ABS
+     V_GT01 V_LT01      compare, giving 1.0 / 0.0 per lane
+     mtype, M_LT M_GT M_ORD, V_BLEND(m, a, b) = m ? a : b, V_MASKZ(m, a)
+                        lane masks for the describe kernel
+     M_ANY(m)           nonzero when any lane of m is set
+     M_NZ(a)            lanes that are nonzero (NaN included)
+     V_COMPRESS(p, v, m) stores the lanes of v selected by m packed at p,
+                        possibly writing all VW lanes, and returns how
+                        many were selected
+     V_SQRT(a)          packed square root, for vmath_impl.h
+
+   V_MIN(x, acc) / V_MAX(x, acc) must return acc when x is NaN, which is
+   what minpd / maxpd do with the new value as first operand. */
+
+#define S_ADD(x, y)  ((x) + (y))
+#define S_SUB(x, y)  ((x) - (y))
+#define S_MUL(x, y)  ((x) * (y))
+#define S_DIV(x, y)  ((x) / (y))
+#define S_GT01(x, y) ((x) > (y) ? 1.0 : 0.0)
+#define S_LT01(x, y) ((x) < (y) ? 1.0 : 0.0)
+#define S_EQ01(x, y) (fabs((x) - (y)) < VEC_EQ_EPS ? 1.0 : 0.0)
+#define S_MIN(x, acc) ((x) < (acc) ? (x) : (acc))
+#define S_MAX(x, acc) ((x) > (acc) ? (x) : (acc))
+
+#define V_EQ01(a, b) V_LT01(V_ABS(V_SUB(a, b)), V_SET1(VEC_EQ_EPS))
+
+/* ===========================================
+                Elementwise
+   =========================================== */
+
+#define BINARY_KERNEL(name, VOP, SOP)                                           \
+static KERNEL_TARGET void KN(name)(double *dst, const double *a,                \
+                                   const double *b, size_t n)                   \
+{                                                                               \
+    size_t i = 0;                                                               \
+    for (; i + VW <= n; i += VW)                                                \
+        V_STORE(dst + i, VOP(V_LOAD(a + i), V_LOAD(b + i)));                    \
+    for (; i < n; i++)                                                          \
+        dst[i] = SOP(a[i], b[i]);                                               \
+}
+
+#define SCALAR_KERNEL(name, VOP, SOP)                                           \
+static KERNEL_TARGET void KN(name)(double *dst, const double *x,                \
+                                   double s, size_t n)                          \
+{                                                                               \
+    vtype vs = V_SET1(s);                                                       \
+    size_t i = 0;                                                               \
+    for (; i + VW <= n; i += VW)                                                \
+        V_STORE(dst + i, VOP(V_LOAD(x + i), vs));                               \
+    for (; i < n; i++)                                                          \
+        dst[i] = SOP(x[i], s);                                                  \
+}
+
+BINARY_KERNEL(add, V_ADD, S_ADD)
+BINARY_KERNEL(sub, V_SUB, S_SUB)
+BINARY_KERNEL(mul, V_MUL, S_MUL)
+
+SCALAR_KERNEL(add_scalar, V_ADD, S_ADD)
+SCALAR_KERNEL(sub_scalar, V_SUB, S_SUB)
+SCALAR_KERNEL(mul_scalar, V_MUL, S_MUL)
+SCALAR_KERNEL(div_scalar, V_DIV, S_DIV)
+
+BINARY_KERNEL(gt, V_GT01, S_GT01)
+BINARY_KERNEL(lt, V_LT01, S_LT01)
+BINARY_KERNEL(eq, V_EQ01, S_EQ01)
+
+SCALAR_KERNEL(gt_scalar, V_GT01, S_GT01)
+SCALAR_KERNEL(lt_scalar, V_LT01, S_LT01)
+SCALAR_KERNEL(eq_scalar, V_EQ01, S_EQ01)
+
+/* ===========================================
+                Reductions
+   =========================================== */
+
+/* four independent accumulators hide the add latency; lanes are folded in
+   a fixed order so a given level always returns the same bits. VSTEP adds
+   one register into an accumulator, FOLD merges a finished lane and STEP
+   handles the scalar tail. */
+#define REDUCE_KERNEL(name, INIT, VSTEP, FOLD, STEP)                            \
+static KERNEL_TARGET double KN(name)(const double *x, size_t n)                 \
+{                                                                               \
+    vtype a0 = V_SET1(INIT), a1 = a0, a2 = a0, a3 = a0;                         \
+    size_t i = 0;                                                               \
+    for (; i + 4 * VW <= n; i += 4 * VW) {                                      \
+        a0 = VSTEP(V_LOAD(x + i), a0);                                          \
+        a1 = VSTEP(V_LOAD(x + i + VW), a1);                                     \
+        a2 = VSTEP(V_LOAD(x + i + 2 * VW), a2);                                 \
+        a3 = VSTEP(V_LOAD(x + i + 3 * VW), a3);                                 \
+    }                                                                           \
+    for (; i + VW <= n; i += VW)                                                \
+        a0 = VSTEP(V_LOAD(x + i), a0);                                          \
+                                                                                \
+    double lanes[4][VW];                                                        \
+    V_STORE(lanes[0], a0);                                                      \
+    V_STORE(lanes[1], a1);                                                      \
+    V_STORE(lanes[2], a2);                                                      \
+    V_STORE(lanes[3], a3);                                                      \
+                                                                                \
+    double acc = INIT;                                                          \
+    for (int k = 0; k < 4; k++)                                                 \
+        for (int j = 0; j < VW; j++)                                            \
+            acc = FOLD(lanes[k][j], acc);                                       \
+    for (; i < n; i++)                                                          \
+        acc = STEP(x[i], acc);                                                  \
+    return acc;                                                                 \
+}
+
+#define V_SUM_STEP(v, acc) V_ADD(acc, v)
+#define V_SQ_STEP(v, acc)  V_ADD(acc, V_MUL(v, v))
+#define S_SUM_STEP(v, acc) ((acc) + (v))
+#define S_SQ_STEP(v, acc)  ((acc) + (v) * (v))
+
+REDUCE_KERNEL(sum, 0.0, V_SUM_STEP, S_SUM_STEP, S_SUM_STEP)
+REDUCE_KERNEL(sum_sq, 0.0, V_SQ_STEP, S_SUM_STEP, S_SQ_STEP)
+REDUCE_KERNEL(min, DBL_MAX, V_MIN, S_MIN, S_MIN)
+REDUCE_KERNEL(max, -DBL_MAX, V_MAX, S_MAX, S_MAX)
+
+/* Neumaier's variant of Kahan summation, one (sum, compensation) pair per
+   lane and two pairs in flight. The compensation picks whichever operand
+   was the smaller, so it stays exact when a term dwarfs the running sum. */
+static KERNEL_TARGET double KN(sum_kahan)(const double *x, size_t n)
+{
+    vtype s0 = V_SET1(0.0), s1 = s0, c0 = s0, c1 = s0;
+    size_t i = 0;
+
+#define NEUMAIER_STEP(v, s, c)                                                  \
+    do {                                                                        \
+        vtype t_ = V_ADD(s, v);                                                 \
+        mtype m_ = M_LT(V_ABS(s), V_ABS(v));                                    \
+        c = V_ADD(c, V_BLEND(m_, V_ADD(V_SUB(v, t_), s), V_ADD(V_SUB(s, t_), v))); \
+        s = t_;                                                                 \
+    } while (0)
+
+    for (; i + 2 * VW <= n; i += 2 * VW) {
+        vtype v0 = V_LOAD(x + i), v1 = V_LOAD(x + i + VW);
+        NEUMAIER_STEP(v0, s0, c0);
+        NEUMAIER_STEP(v1, s1, c1);
+    }
+    for (; i + VW <= n; i += VW) {
+        vtype v0 = V_LOAD(x + i);
+        NEUMAIER_STEP(v0, s0, c0);
+    }
+#undef NEUMAIER_STEP
+
+    double s_l[2][VW], c_l[2][VW];
+    V_STORE(s_l[0], s0);  V_STORE(s_l[1], s1);
+    V_STORE(c_l[0], c0);  V_STORE(c_l[1], c1);
+
+    double s = 0.0, c = 0.0;
+    for (int k = 0; k < 2; k++)
+        for (int j = 0; j < VW; j++)
+            vec_neumaier_add(&s, &c, s_l[k][j]), c += c_l[k][j];
+    for (; i < n; i++)
+        vec_neumaier_add(&s, &c, x[i]);
+
+    /* an infinite sum leaves NaN in the compensation; the sum is the answer */
+    return isfinite(s) ? s + c : s;
+}
+
+/* ===========================================
+                Threshold scans
+   =========================================== */
+
+/* index of the first element strictly above / below t, or n; NaN never
+   qualifies. Four registers are tested per step and only a hit drops to
+   the scalar loop, so a scan that rarely finds anything runs at load
+   speed. */
+#define SCAN_KERNEL(name, MCMP, SCMP)                                           \
+static KERNEL_TARGET size_t KN(name)(const double *x, size_t n, double t)      \
+{                                                                               \
+    vtype vt = V_SET1(t);                                                       \
+    size_t i = 0;                                                               \
+    for (; i + 4 * VW <= n; i += 4 * VW) {                                      \
+        int hit = M_ANY(MCMP(V_LOAD(x + i), vt))                                \
+                | M_ANY(MCMP(V_LOAD(x + i + VW), vt))                           \
+                | M_ANY(MCMP(V_LOAD(x + i + 2 * VW), vt))                       \
+                | M_ANY(MCMP(V_LOAD(x + i + 3 * VW), vt));                      \
+        if (hit) break;                                                         \
+    }                                                                           \
+    for (; i < n; i++)                                                          \
+        if (SCMP(x[i], t)) return i;                                            \
+    return n;                                                                   \
+}
+
+#define S_GT(x, t) ((x) > (t))
+#define S_LT(x, t) ((x) < (t))
+
+SCAN_KERNEL(find_above, M_GT, S_GT)
+SCAN_KERNEL(find_below, M_LT, S_LT)
+
+/* ===========================================
+                Selection
+   =========================================== */
+
+/* mask lanes count as set when nonzero, NaN included, like mask_from_vec */
+static KERNEL_TARGET void KN(where)(double *dst, const double *mask, const double *a,
+                                   const double *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + VW <= n; i += VW)
+        V_STORE(dst + i, V_BLEND(M_NZ(V_LOAD(mask + i)), V_LOAD(a + i), V_LOAD(b + i)));
+    for (; i < n; i++)
+        dst[i] = mask[i] != 0.0 ? a[i] : b[i];
+}
+
+static KERNEL_TARGET size_t KN(count_nonzero)(const double *mask, size_t n)
+{
+    vtype one = V_SET1(1.0), acc = V_SET1(0.0);
+    size_t i = 0;
+    for (; i + VW <= n; i += VW)
+        acc = V_ADD(acc, V_MASKZ(M_NZ(V_LOAD(mask + i)), one));
+
+    double lanes[VW];
+    V_STORE(lanes, acc);
+
+    size_t count = 0;
+    for (int j = 0; j < VW; j++) count += (size_t)lanes[j];
+    for (; i < n; i++) count += (mask[i] != 0.0);
+    return count;
+}
+
+/* Stream compaction: x[i] for every set mask[i], packed into dst, which
+   has room for exactly cap of them. Each step stores a whole register and
+   advances by the number selected, so there is no per-element branch;
+   the last registers that might spill past cap go one element at a time
+   (still branch-free: store, then advance by the mask bit). */
+static KERNEL_TARGET size_t KN(compress)(double *dst, const double *x, const double *mask,
+                                         size_t n, size_t cap)
+{
+    size_t i = 0, k = 0;
+    for (; i + VW <= n && k + VW <= cap; i += VW)
+        k += V_COMPRESS(dst + k, V_LOAD(x + i), M_NZ(V_LOAD(mask + i)));
+    for (; i < n && k < cap; i++) {
+        dst[k] = x[i];
+        k += (mask[i] != 0.0);
+    }
+    return k;
+}
+
+/* ===========================================
+                Describe
+   =========================================== */
+
+/* the caller hands in blocks small enough to stay in L1, so the second
+   sweep for the centred sum of squares costs no memory traffic */
+static KERNEL_TARGET void KN(describe)(const double *x, size_t n, struct VecBlockStats *out)
+{
+    static const double iota[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+    vtype zero = V_SET1(0.0), one = V_SET1(1.0), step = V_SET1((double)VW);
+    vtype cnt = zero, sum = zero, l1 = zero, l2 = zero;
+    vtype mn = V_SET1(INFINITY), mx = V_SET1(-INFINITY);
+    vtype imn = V_SET1(-1.0), imx = imn;
+    vtype idx = V_LOAD(iota);
+    size_t i = 0;
+
+    for (; i + VW <= n; i += VW) {
+        vtype v = V_LOAD(x + i);
+        mtype ord = M_ORD(v);
+        vtype vz = V_MASKZ(ord, v);
+
+        cnt = V_ADD(cnt, V_MASKZ(ord, one));
+        sum = V_ADD(sum, vz);
+        l1 = V_ADD(l1, V_ABS(vz));
+        l2 = V_ADD(l2, V_MUL(vz, vz));
+
+        /* strict compares keep the first index per lane, NaN never wins */
+        mtype lt = M_LT(v, mn);
+        mn = V_BLEND(lt, v, mn);
+        imn = V_BLEND(lt, idx, imn);
+        mtype gt = M_GT(v, mx);
+        mx = V_BLEND(gt, v, mx);
+        imx = V_BLEND(gt, idx, imx);
+
+        idx = V_ADD(idx, step);
+    }
+
+    double c_l[VW], s_l[VW], a_l[VW], q_l[VW], mn_l[VW], mx_l[VW], imn_l[VW], imx_l[VW];
+    V_STORE(c_l, cnt);  V_STORE(s_l, sum);  V_STORE(a_l, l1);  V_STORE(q_l, l2);
+    V_STORE(mn_l, mn);  V_STORE(mx_l, mx);  V_STORE(imn_l, imn);  V_STORE(imx_l, imx);
+
+    double c = 0.0, s = 0.0, a = 0.0, q = 0.0;
+    double best_mn = INFINITY, best_mx = -INFINITY, at_mn = -1.0, at_mx = -1.0;
+
+    for (int j = 0; j < VW; j++) {
+        c += c_l[j];  s += s_l[j];  a += a_l[j];  q += q_l[j];
+
+        /* across lanes a tie goes to the lower index */
+        if (imn_l[j] >= 0.0 && (mn_l[j] < best_mn || (mn_l[j] == best_mn && (at_mn < 0.0 || imn_l[j] < at_mn)))) {
+            best_mn = mn_l[j];
+            at_mn = imn_l[j];
+        }
+        if (imx_l[j] >= 0.0 && (mx_l[j] > best_mx || (mx_l[j] == best_mx && (at_mx < 0.0 || imx_l[j] < at_mx)))) {
+            best_mx = mx_l[j];
+            at_mx = imx_l[j];
+        }
+    }
+
+    for (; i < n; i++) {
+        double v = x[i];
+        if (v != v) continue;
+        c += 1.0;  s += v;  a += fabs(v);  q += v * v;
+        if (v < best_mn) { best_mn = v; at_mn = (double)i; }
+        if (v > best_mx) { best_mx = v; at_mx = (double)i; }
+    }
+
+    double m2 = 0.0;
+    if (c > 0.0) {
+        vtype mean = V_SET1(s / c), acc = zero;
+        for (i = 0; i + VW <= n; i += VW) {
+            vtype v = V_LOAD(x + i);
+            vtype d = V_MASKZ(M_ORD(v), V_SUB(v, mean));
+            acc = V_ADD(acc, V_MUL(d, d));
+        }
+
+        double m_l[VW];
+        V_STORE(m_l, acc);
+        for (int j = 0; j < VW; j++) m2 += m_l[j];
+
+        for (; i < n; i++) {
+            if (x[i] != x[i]) continue;
+            double d = x[i] - s / c;
+            m2 += d * d;
+        }
+    }
+
+    out->count = (size_t)c;
+    out->sum = s;
+    out->m2 = m2;
+    out->min = best_mn;
+    out->max = best_mx;
+    out->argmin = at_mn < 0.0 ? SIZE_MAX : (size_t)at_mn;
+    out->argmax = at_mx < 0.0 ? SIZE_MAX : (size_t)at_mx;
+    out->l1 = a;
+    out->l2sq = q;
+}
+
+/* ===========================================
+                Moments
+   =========================================== */
+
+/* Moments of one L1-sized block: the means come from the sum kernel, then
+   the centred sums are taken on the second, cache-hot sweep. b may be
+   NULL, leaving the b fields zero. */
+static KERNEL_TARGET void KN(moments)(const double *a, const double *b, size_t n, struct VecMoments *out)
+{
+    vtype zero = V_SET1(0.0);
+    double ma = KN(sum)(a, n) / (double)n;
+    double mb = b ? KN(sum)(b, n) / (double)n : 0.0;
+    double saa = 0.0, sbb = 0.0, sab = 0.0;
+    size_t i = 0;
+
+    if (!b) {
+        vtype va = V_SET1(ma), q0 = zero, q1 = zero;
+        for (; i + 2 * VW <= n; i += 2 * VW) {
+            vtype d0 = V_SUB(V_LOAD(a + i), va), d1 = V_SUB(V_LOAD(a + i + VW), va);
+            q0 = V_ADD(q0, V_MUL(d0, d0));
+            q1 = V_ADD(q1, V_MUL(d1, d1));
+        }
+        double l[2][VW];
+        V_STORE(l[0], q0);  V_STORE(l[1], q1);
+        for (int k = 0; k < 2; k++)
+            for (int j = 0; j < VW; j++) saa += l[k][j];
+    } else {
+        vtype va = V_SET1(ma), vb = V_SET1(mb), qa = zero, qb = zero, qab = zero;
+        for (; i + VW <= n; i += VW) {
+            vtype da = V_SUB(V_LOAD(a + i), va), db = V_SUB(V_LOAD(b + i), vb);
+            qa = V_ADD(qa, V_MUL(da, da));
+            qb = V_ADD(qb, V_MUL(db, db));
+            qab = V_ADD(qab, V_MUL(da, db));
+        }
+        double la[VW], lb[VW], lab[VW];
+        V_STORE(la, qa);  V_STORE(lb, qb);  V_STORE(lab, qab);
+        for (int j = 0; j < VW; j++) {
+            saa += la[j];  sbb += lb[j];  sab += lab[j];
+        }
+    }
+
+    for (; i < n; i++) {
+        double da = a[i] - ma;
+        saa += da * da;
+        if (b) {
+            double db = b[i] - mb;
+            sbb += db * db;
+            sab += da * db;
+        }
+    }
+
+    out->count = n;
+    out->mean_a = ma;
+    out->mean_b = mb;
+    out->m2_a = saa;
+    out->m2_b = sbb;
+    out->c_ab = sab;
+}
+
+#include "vmath_impl.h"
+
+const struct VecKernels KTABLE = {
+	KISA,
+	KN(add), KN(sub), KN(mul),
+	KN(add_scalar), KN(sub_scalar), KN(mul_scalar), KN(div_scalar),
+	KN(gt), KN(lt), KN(eq),
+	KN(gt_scalar), KN(lt_scalar), KN(eq_scalar),
+	KN(sum), KN(sum_sq), KN(min), KN(max),
+	KN(sum_kahan),
+	KN(describe),
+	KN(moments),
+	KN(find_above), KN(find_below),
+	KN(where), KN(count_nonzero), KN(compress),
+	KN(exp), KN(log),
+	KN(sin), KN(cos), KN(tan),
+	KN(sinh), KN(cosh), KN(tanh),
+	KN(sqrt),
+};
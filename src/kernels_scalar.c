@@ -0,0 +1,44 @@
+/* kernels_scalar.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+/* Portable level: one double per "register", used on non-x86 targets and
+   when AXPY_ISA=scalar. */
+
+#define KERNEL_TARGET
+#define KN(name) scalar_##name
+#define KTABLE   vec_kernels_scalar
+#define KISA     VEC_ISA_SCALAR
+
+#define VW 1
+typedef double vtype;
+
+#define V_LOAD(p)      (*(p))
+#define V_STORE(p, v)  (*(p) = (v))
+#define V_SET1(s)      (s)
+#define V_ADD(a, b)    ((a) + (b))
+#define V_SUB(a, b)    ((a) - (b))
+#define V_MUL(a, b)    ((a) * (b))
+#define V_DIV(a, b)    ((a) / (b))
+#define V_MIN(x, acc)  ((x) < (acc) ? (x) : (acc))
+#define V_MAX(x, acc)  ((x) > (acc) ? (x) : (acc))
+#define V_ABS(a)       fabs(a)
+#define V_SQRT(a)      sqrt(a)
+#define V_GT01(a, b)   ((a) > (b) ? 1.0 : 0.0)
+#define V_LT01(a, b)   ((a) < (b) ? 1.0 : 0.0)
+
+typedef int mtype;
+
+#define M_LT(a, b)       ((a) < (b))
+#define M_GT(a, b)       ((a) > (b))
+#define M_ORD(a)         ((a) == (a))
+#define M_ANY(m)         (m)
+#define M_NZ(a)          ((a) != 0.0)
+
+#define V_COMPRESS(p, v, m) (*(p) = (v), (size_t)((m) != 0))
+#define V_BLEND(m, a, b) ((m) ? (a) : (b))
+#define V_MASKZ(m, a)    ((m) ? (a) : 0.0)
+
+#include "kernels_impl.h"
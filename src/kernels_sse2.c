@@ -0,0 +1,55 @@
+/* kernels_sse2.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+#define KERNEL_TARGET __attribute__((target("sse2")))
+#define KN(name) sse2_##name
+#define KTABLE   vec_kernels_sse2
+#define KISA     VEC_ISA_SSE2
+
+#define VW 2
+typedef __m128d vtype;
+
+#define V_LOAD(p)      _mm_loadu_pd(p)
+#define V_STORE(p, v)  _mm_storeu_pd(p, v)
+#define V_SET1(s)      _mm_set1_pd(s)
+#define V_ADD(a, b)    _mm_add_pd(a, b)
+#define V_SUB(a, b)    _mm_sub_pd(a, b)
+#define V_MUL(a, b)    _mm_mul_pd(a, b)
+#define V_DIV(a, b)    _mm_div_pd(a, b)
+#define V_MIN(x, acc)  _mm_min_pd(x, acc)
+#define V_MAX(x, acc)  _mm_max_pd(x, acc)
+#define V_ABS(a)       _mm_andnot_pd(_mm_set1_pd(-0.0), a)
+#define V_SQRT(a)      _mm_sqrt_pd(a)
+#define V_GT01(a, b)   _mm_and_pd(_mm_cmpgt_pd(a, b), _mm_set1_pd(1.0))
+#define V_LT01(a, b)   _mm_and_pd(_mm_cmplt_pd(a, b), _mm_set1_pd(1.0))
+
+typedef __m128d mtype;
+
+#define M_LT(a, b)       _mm_cmplt_pd(a, b)
+#define M_GT(a, b)       _mm_cmpgt_pd(a, b)
+#define M_ORD(a)         _mm_cmpord_pd(a, a)
+#define M_ANY(m)         _mm_movemask_pd(m)
+#define M_NZ(a)          _mm_cmpneq_pd(a, _mm_setzero_pd())
+
+/* two lanes: only "high lane alone" needs moving */
+static KERNEL_TARGET inline size_t sse2_compress_lanes(double *p, __m128d v, __m128d m)
+{
+    int bits = _mm_movemask_pd(m);
+    _mm_storeu_pd(p, bits == 2 ? _mm_unpackhi_pd(v, v) : v);
+    return (size_t)((bits & 1) + (bits >> 1));
+}
+
+#define V_COMPRESS(p, v, m) sse2_compress_lanes(p, v, m)
+#define V_BLEND(m, a, b) _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b))
+#define V_MASKZ(m, a)    _mm_and_pd(m, a)
+
+#include "kernels_impl.h"
+
+#endif
@@ -0,0 +1,203 @@
+/* mmap.c */
+
+/* mmap/madvise and 64-bit file offsets are hidden by -std=c11 */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+#ifndef _FILE_OFFSET_BITS
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "libs.h"
+#include "vector.h"
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/* what vec_mmap_close needs to undo the mapping; vec comes first so a
+   struct Vector pointer handed to the caller converts back */
+struct MappedVector {
+    struct Vector vec;
+    void *base;
+    size_t length;
+};
+
+#if !defined(_WIN32)
+
+static int mmap_advice(int mode)
+{
+    if (mode & VEC_MMAP_SEQUENTIAL) return MADV_SEQUENTIAL;
+    if (mode & VEC_MMAP_RANDOM)     return MADV_RANDOM;
+    if (mode & VEC_MMAP_WILLNEED)   return MADV_WILLNEED;
+    return MADV_NORMAL;
+}
+
+struct Vector *vec_mmap_open_range(const char *path, int mode, size_t offset, size_t count)
+{
+    if (!path) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_mmap_open error: path is NULL\n");
+        return NULL;
+    }
+
+    if (offset % sizeof(double) != 0) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_mmap_open error: offset %zu is not a multiple of %zu\n",
+                offset, sizeof(double));
+        return NULL;
+    }
+
+    int writable = (mode & (VEC_MMAP_RDWR | VEC_MMAP_PRIVATE)) != 0;
+    int fd = open(path, (mode & VEC_MMAP_RDWR) ? O_RDWR : O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "vec_mmap_open error: cannot open %s (%s)\n", path, strerror(errno));
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        int err = errno;
+        fprintf(stderr, "vec_mmap_open error: cannot stat %s (%s)\n", path, strerror(err));
+        close(fd);
+        errno = err;
+        return NULL;
+    }
+
+    size_t file_size = (size_t)st.st_size;
+    if (offset > file_size) {
+        close(fd);
+        errno = EINVAL;
+        fprintf(stderr, "vec_mmap_open error: offset is past the end of %s\n", path);
+        return NULL;
+    }
+
+    size_t available = (file_size - offset) / sizeof(double);
+    if (count == 0) count = available;
+
+    if (count == 0 || count > available) {
+        close(fd);
+        errno = EINVAL;
+        fprintf(stderr, "vec_mmap_open error: %s holds %zu elements past offset %zu, %zu requested\n",
+                path, available, offset, count);
+        return NULL;
+    }
+
+    /* mmap offsets must be page aligned, so map from the page holding offset */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t map_offset = offset - offset % page;
+    size_t length = (offset - map_offset) + count * sizeof(double);
+
+    int prot = PROT_READ | (writable ? PROT_WRITE : 0);
+    int flags = (mode & VEC_MMAP_RDWR) ? MAP_SHARED : MAP_PRIVATE;
+
+    void *base = mmap(NULL, length, prot, flags, fd, (off_t)map_offset);
+    int err = errno;
+    close(fd);   /* the mapping keeps its own reference to the file */
+
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "vec_mmap_open error: mmap of %s failed (%s)\n", path, strerror(err));
+        errno = err;
+        return NULL;
+    }
+
+    /* only a hint, failure is harmless */
+    madvise(base, length, mmap_advice(mode));
+
+    struct MappedVector *mv = malloc(sizeof *mv);
+    if (!mv) {
+        munmap(base, length);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_mmap_open error: failed to allocate Vector struct (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    mv->vec.size = count;
+    mv->vec.data = (double *)((unsigned char *)base + (offset - map_offset));
+    mv->vec.storage = VEC_STORAGE_MMAP;
+    mv->base = base;
+    mv->length = length;
+
+    return &mv->vec;
+}
+
+int vec_mmap_advise(struct Vector *v, int mode)
+{
+    if (!v || v->storage != VEC_STORAGE_MMAP) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct MappedVector *mv = (struct MappedVector *)v;
+    return madvise(mv->base, mv->length, mmap_advice(mode));
+}
+
+int vec_mmap_sync(struct Vector *v)
+{
+    if (!v || v->storage != VEC_STORAGE_MMAP) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    struct MappedVector *mv = (struct MappedVector *)v;
+    return msync(mv->base, mv->length, MS_SYNC);
+}
+
+int vec_mmap_close(struct Vector *v)
+{
+    if (!v) return 0;
+
+    if (v->storage != VEC_STORAGE_MMAP) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_mmap_close error: vector is not file-backed\n");
+        return -1;
+    }
+
+    struct MappedVector *mv = (struct MappedVector *)v;
+    int rc = munmap(mv->base, mv->length);
+    free(mv);
+
+    return rc;
+}
+
+#else /* _WIN32 */
+
+struct Vector *vec_mmap_open_range(const char *path, int mode, size_t offset, size_t count)
+{
+    (void)path; (void)mode; (void)offset; (void)count;
+    errno = ENOSYS;
+    fprintf(stderr, "vec_mmap_open error: file mappings are not supported on this platform\n");
+    return NULL;
+}
+
+int vec_mmap_advise(struct Vector *v, int mode)
+{
+    (void)v; (void)mode;
+    errno = ENOSYS;
+    return -1;
+}
+
+int vec_mmap_sync(struct Vector *v)
+{
+    (void)v;
+    errno = ENOSYS;
+    return -1;
+}
+
+int vec_mmap_close(struct Vector *v)
+{
+    (void)v;
+    errno = ENOSYS;
+    return -1;
+}
+
+#endif
+
+struct Vector *vec_mmap_open(const char *path, int mode)
+{
+    return vec_mmap_open_range(path, mode, 0, 0);
+}
@@ -0,0 +1,53 @@
+/* parallel.c */
+
+/* sysconf is POSIX, hidden by -std=c11 */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+#include <pthread.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/* ===========================================
+                Worker threads
+   =========================================== */
+
+int vec_parallel_threads(int nthreads, size_t n)
+{
+    long t = nthreads;
+
+    if (t <= 0) {
+#if !defined(_WIN32)
+        t = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+        if (t < 1) t = 1;
+    }
+    if (t > VEC_MAX_THREADS) t = VEC_MAX_THREADS;
+    if ((size_t)t > n / VEC_PARALLEL_MIN_CHUNK) t = (long)(n / VEC_PARALLEL_MIN_CHUNK);
+    return t < 1 ? 1 : (int)t;
+}
+
+/* a thread that cannot be created runs its block inline instead */
+void vec_run_parallel(void *(*fn)(void *), void *args, size_t arg_size, int count)
+{
+    pthread_t threads[VEC_MAX_THREADS];
+    int started[VEC_MAX_THREADS];
+
+    for (int t = 1; t < count; t++) {
+        void *arg = (char *)args + (size_t)t * arg_size;
+        started[t] = pthread_create(&threads[t], NULL, fn, arg) == 0;
+        if (!started[t]) fn(arg);
+    }
+
+    fn(args);
+
+    for (int t = 1; t < count; t++)
+        if (started[t]) pthread_join(threads[t], NULL);
+}
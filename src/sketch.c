@@ -0,0 +1,356 @@
+/* sketch.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "sketch.h"
+
+#ifndef M_PI
+#define M_PI 3.1415926535897932
+#endif
+
+/* raw values collected before they are sorted and folded into the
+   centroids; big enough that the radix sort and the merge amortise */
+#define SKETCH_BUFFER 4096
+
+/* smaller compressions leave too few centroids to interpolate */
+#define SKETCH_MIN_COMPRESSION 10.0
+
+struct VecSketch {
+    double compression;
+
+    /* centroids sorted by mean; spare_* is the merge target */
+    double *mean, *weight;
+    double *spare_mean, *spare_weight;
+    double *arrays;             /* one allocation behind all four */
+    size_t count, cap;
+    double total;               /* weight held by the centroids */
+
+    double *buffer;
+    size_t buffered;
+
+    /* infinities are only counted: merged into a centroid they would turn
+       its running mean into NaN, and no finite rank can land on them */
+    size_t neg_inf, pos_inf;
+
+    double min, max;            /* finite extremes */
+};
+
+/* ===========================================
+                Create / destroy
+   =========================================== */
+
+struct VecSketch *vec_sketch_create(double compression)
+{
+    if (compression == 0.0) compression = VEC_SKETCH_DEFAULT_COMPRESSION;
+
+    if (!(compression > 0.0) || !isfinite(compression)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_create error: compression must be positive and finite\n");
+        return NULL;
+    }
+
+    if (compression < SKETCH_MIN_COMPRESSION) compression = SKETCH_MIN_COMPRESSION;
+
+    struct VecSketch *s = calloc(1, sizeof *s);
+    if (!s) {
+        errno = ENOMEM;
+        fprintf(stderr, "vec_sketch_create error: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    /* the k1 scale spans compression / 2 units and two neighbouring
+       centroids always cover more than one, so compression + 1 is the
+       most that can survive a merge; the rest is headroom */
+    s->compression = compression;
+    s->cap = (size_t)ceil(2.0 * compression) + 16;
+    s->arrays = malloc(4 * s->cap * sizeof(double));
+    s->buffer = vec_aligned_alloc(SKETCH_BUFFER * sizeof(double));
+    if (!s->arrays || !s->buffer) {
+        free(s->arrays);
+        vec_aligned_free(s->buffer);
+        free(s);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_sketch_create error: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    s->mean = s->arrays;
+    s->weight = s->arrays + s->cap;
+    s->spare_mean = s->arrays + 2 * s->cap;
+    s->spare_weight = s->arrays + 3 * s->cap;
+    s->min = INFINITY;
+    s->max = -INFINITY;
+
+    return s;
+}
+
+void vec_sketch_destroy(struct VecSketch *sketch)
+{
+    if (!sketch) return;
+
+    free(sketch->arrays);
+    vec_aligned_free(sketch->buffer);
+    free(sketch);
+}
+
+/* ===========================================
+                Compression
+   =========================================== */
+
+/* Upper quantile a centroid starting at q may reach: one unit of the k1
+   scale k(q) = compression / (2 pi) * asin(2q - 1) further on */
+static double q_limit(double compression, double q)
+{
+    double a = asin(2.0 * q - 1.0) + 2.0 * M_PI / compression;
+    if (a >= M_PI / 2.0) return 1.0;
+    return (sin(a) + 1.0) / 2.0;
+}
+
+/* Folds a second sorted list (weights NULL: all 1) into the centroids in
+   one merge-walk, greedily growing each centroid up to its size limit */
+static void compress(struct VecSketch *s, const double *b_mean, const double *b_weight, size_t b_count)
+{
+    if (b_count == 0) return;
+
+    double b_total = 0.0;
+    if (b_weight) {
+        for (size_t j = 0; j < b_count; j++) b_total += b_weight[j];
+    } else {
+        b_total = (double)b_count;
+    }
+
+    double total = s->total + b_total;
+    size_t i = 0, j = 0, out = 0;
+    double cur_mean = 0.0, cur_weight = 0.0, so_far = 0.0;
+    double limit = total * q_limit(s->compression, 0.0);
+
+    while (i < s->count || j < b_count) {
+        double m, w;
+
+        /* ties take the existing centroid first, keeping merges deterministic */
+        if (j >= b_count || (i < s->count && s->mean[i] <= b_mean[j])) {
+            m = s->mean[i];
+            w = s->weight[i];
+            i++;
+        } else {
+            m = b_mean[j];
+            w = b_weight ? b_weight[j] : 1.0;
+            j++;
+        }
+
+        if (cur_weight == 0.0) {
+            cur_mean = m;
+            cur_weight = w;
+        } else if (so_far + cur_weight + w <= limit || out + 1 >= s->cap) {
+            cur_weight += w;
+            cur_mean += (m - cur_mean) * w / cur_weight;
+        } else {
+            s->spare_mean[out] = cur_mean;
+            s->spare_weight[out] = cur_weight;
+            out++;
+            so_far += cur_weight;
+            limit = total * q_limit(s->compression, so_far / total);
+            cur_mean = m;
+            cur_weight = w;
+        }
+    }
+
+    s->spare_mean[out] = cur_mean;
+    s->spare_weight[out] = cur_weight;
+    out++;
+
+    double *t = s->mean;
+    s->mean = s->spare_mean;
+    s->spare_mean = t;
+    t = s->weight;
+    s->weight = s->spare_weight;
+    s->spare_weight = t;
+
+    s->count = out;
+    s->total = total;
+}
+
+static int flush(struct VecSketch *s)
+{
+    if (s->buffered == 0) return 0;
+
+    struct Vector pending = { s->buffered, s->buffer, VEC_STORAGE_HEAP };
+    if (vec_sort(&pending) != 0) return -1;
+
+    compress(s, s->buffer, NULL, s->buffered);
+    s->buffered = 0;
+    return 0;
+}
+
+/* ===========================================
+                Insertion
+   =========================================== */
+
+int vec_sketch_add(struct VecSketch *sketch, double x)
+{
+    if (!sketch) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_add error: sketch pointer is NULL\n");
+        return -1;
+    }
+
+    if (x != x) return 0;
+
+    if (isinf(x)) {
+        if (x < 0.0) sketch->neg_inf++;
+        else sketch->pos_inf++;
+        return 0;
+    }
+
+    if (x < sketch->min) sketch->min = x;
+    if (x > sketch->max) sketch->max = x;
+
+    sketch->buffer[sketch->buffered++] = x;
+    if (sketch->buffered == SKETCH_BUFFER) return flush(sketch);
+    return 0;
+}
+
+int vec_sketch_add_vector(struct VecSketch *sketch, const struct Vector *v)
+{
+    if (!sketch || !v || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_add_vector error: sketch or vector pointer is NULL\n");
+        return -1;
+    }
+
+    double lo = sketch->min, hi = sketch->max;
+    size_t neg = 0, pos = 0;
+    const double *x = v->data;
+    int rc = 0;
+
+    for (size_t i = 0; i < v->size;) {
+        double *buf = sketch->buffer;
+        size_t at = sketch->buffered;
+        size_t room = SKETCH_BUFFER - at;
+        size_t end = v->size - i < room ? i + (v->size - i) : i + room;
+
+        /* branch-free copy that leaves NaNs and infinities behind
+           (t - t is 0 only for finite t) and counts the infinities */
+        for (; i < end; i++) {
+            double t = x[i];
+            int finite = (t - t == 0.0);
+            buf[at] = t;
+            at += finite;
+            neg += (t == -INFINITY);
+            pos += (t == INFINITY);
+            lo = finite && t < lo ? t : lo;
+            hi = finite && t > hi ? t : hi;
+        }
+
+        sketch->buffered = at;
+        if (at == SKETCH_BUFFER && flush(sketch) != 0) {
+            rc = -1;
+            break;
+        }
+    }
+
+    /* what reached the buffer stays accounted for, even after a failure */
+    sketch->min = lo;
+    sketch->max = hi;
+    sketch->neg_inf += neg;
+    sketch->pos_inf += pos;
+    return rc;
+}
+
+int vec_sketch_merge(struct VecSketch *dst, const struct VecSketch *src)
+{
+    if (!dst || !src) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_merge error: sketch pointer is NULL\n");
+        return -1;
+    }
+
+    if (dst == src) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_merge error: cannot merge a sketch into itself\n");
+        return -1;
+    }
+
+    /* src's pending values go through dst's own buffer, its centroids
+       straight into the merge-walk */
+    struct Vector pending = { src->buffered, src->buffer, VEC_STORAGE_HEAP };
+    if (vec_sketch_add_vector(dst, &pending) != 0) return -1;
+    if (flush(dst) != 0) return -1;
+
+    compress(dst, src->mean, src->weight, src->count);
+
+    dst->neg_inf += src->neg_inf;
+    dst->pos_inf += src->pos_inf;
+    if (src->min < dst->min) dst->min = src->min;
+    if (src->max > dst->max) dst->max = src->max;
+    return 0;
+}
+
+/* ===========================================
+                Queries
+   =========================================== */
+
+size_t vec_sketch_count(const struct VecSketch *sketch)
+{
+    if (!sketch) return 0;
+    return (size_t)sketch->total + sketch->buffered + sketch->neg_inf + sketch->pos_inf;
+}
+
+double vec_sketch_percentile(struct VecSketch *sketch, double p)
+{
+    if (!sketch) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sketch_percentile error: sketch pointer is NULL\n");
+        return NAN;
+    }
+
+    if (!(p >= 0.0 && p <= 100.0)) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_sketch_percentile error: p is out of range\n");
+        return NAN;
+    }
+
+    if (flush(sketch) != 0) return NAN;
+
+    struct VecSketch *s = sketch;
+    size_t n = s->count;
+    double neg = (double)s->neg_inf, pos = (double)s->pos_inf;
+    double all = s->total + neg + pos;
+    if (all == 0.0) return NAN;
+
+    /* the infinities own the ranks at either end; the centroids answer
+       whatever lies between */
+    double target = p / 100.0 * all;
+    if (s->neg_inf && (target < neg || (n == 0 && !s->pos_inf))) return -INFINITY;
+    if (s->pos_inf && (target > all - pos || n == 0)) return INFINITY;
+
+    target -= neg;
+    if (target <= 0.0) return s->min;
+    if (target >= s->total) return s->max;
+
+    /* each centroid stands at the middle of its weight; the ends
+       interpolate towards the exact min and max */
+    double first = s->weight[0] / 2.0;
+    if (target < first) {
+        if (s->weight[0] == 1.0) return s->mean[0];
+        return s->min + (s->mean[0] - s->min) * target / first;
+    }
+
+    double last = s->total - s->weight[n - 1] / 2.0;
+    if (target > last) {
+        if (s->weight[n - 1] == 1.0) return s->mean[n - 1];
+        return s->mean[n - 1] + (s->max - s->mean[n - 1]) * (target - last) / (s->total - last);
+    }
+
+    double center = first;
+    for (size_t i = 0; i + 1 < n; i++) {
+        double next = center + (s->weight[i] + s->weight[i + 1]) / 2.0;
+        if (target <= next) {
+            double frac = (target - center) / (next - center);
+            return s->mean[i] + frac * (s->mean[i + 1] - s->mean[i]);
+        }
+        center = next;
+    }
+
+    return s->mean[n - 1];
+}
@@ -0,0 +1,1269 @@
+/* sort.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+/* below this many elements Floyd-Rivest sampling costs more than it saves */
+#define SELECT_SAMPLE_MIN 600
+
+/* ===========================================
+                Helpers
+   =========================================== */
+
+static inline void swap_double(double *x, ptrdiff_t i, ptrdiff_t j)
+{
+    double t = x[i];
+    x[i] = x[j];
+    x[j] = t;
+}
+
+/* NaNs order after +inf, as vec_sort places them. Selection runs on the
+   NaN-free prefix so every compare below is a plain < or >. */
+static size_t nans_to_back(double *x, size_t n)
+{
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        double t = x[i];
+        x[i] = x[m];
+        x[m] = t;
+        m += (t == t);
+    }
+    return m;
+}
+
+/* copy leaving the NaNs out; returns how many were kept */
+static size_t copy_ordered(double *dst, const double *src, size_t n)
+{
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        dst[m] = src[i];
+        m += (src[i] == src[i]);
+    }
+    return m;
+}
+
+static void sift_down(double *x, ptrdiff_t root, ptrdiff_t n)
+{
+    for (;;) {
+        ptrdiff_t child = 2 * root + 1;
+        if (child >= n) return;
+        if (child + 1 < n && x[child + 1] > x[child]) child++;
+        if (!(x[child] > x[root])) return;
+        swap_double(x, root, child);
+        root = child;
+    }
+}
+
+static void heap_sort(double *x, ptrdiff_t n)
+{
+    for (ptrdiff_t i = n / 2 - 1; i >= 0; i--)
+        sift_down(x, i, n);
+    for (ptrdiff_t end = n - 1; end > 0; end--) {
+        swap_double(x, 0, end);
+        sift_down(x, 0, end);
+    }
+}
+
+/* ===========================================
+                Selection
+   =========================================== */
+
+/* Floyd-Rivest: a recursive pick on a small sample brackets the k-th
+   element tightly, so the partition that follows leaves only a sliver
+   on the side of k. After 2 log2(n) rounds without converging (crafted
+   input) the remaining range is heap-sorted, bounding the worst case at
+   O(n log n); expected cost is n + min(k, n - k) compares. */
+static void select_range(double *x, ptrdiff_t left, ptrdiff_t right, ptrdiff_t k, int budget)
+{
+    while (right > left) {
+        if (budget-- <= 0) {
+            heap_sort(x + left, right - left + 1);
+            return;
+        }
+
+        if (right - left > SELECT_SAMPLE_MIN) {
+            double n = (double)(right - left + 1);
+            double i = (double)(k - left + 1);
+            double z = log(n);
+            double s = 0.5 * exp(2.0 * z / 3.0);
+            double sd = 0.5 * sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1.0 : 1.0);
+            ptrdiff_t new_left = (ptrdiff_t)fmax((double)left, floor((double)k - i * s / n + sd));
+            ptrdiff_t new_right = (ptrdiff_t)fmin((double)right, floor((double)k + (n - i) * s / n + sd));
+            select_range(x, new_left, new_right, k, budget);
+        }
+
+        /* partition around t = x[k]; x[left] and x[right] act as sentinels */
+        double t = x[k];
+        ptrdiff_t i = left, j = right;
+
+        swap_double(x, left, k);
+        if (x[right] > t) swap_double(x, right, left);
+
+        while (i < j) {
+            swap_double(x, i, j);
+            i++;
+            j--;
+            while (x[i] < t) i++;
+            while (x[j] > t) j--;
+        }
+
+        if (x[left] == t) {
+            swap_double(x, left, j);
+        } else {
+            j++;
+            swap_double(x, j, right);
+        }
+
+        if (j <= k) left = j + 1;
+        if (k <= j) right = j - 1;
+    }
+}
+
+/* Places the k-th smallest of n NaN-free values at x[k], smaller ones
+   before it and larger ones after */
+static void select_kth(double *x, size_t n, size_t k)
+{
+    int budget = 2;
+    for (size_t m = n; m > 1; m >>= 1) budget += 2;
+
+    select_range(x, 0, (ptrdiff_t)n - 1, (ptrdiff_t)k, budget);
+}
+
+static double max_of(const double *x, size_t n)
+{
+    double best = x[0];
+    for (size_t i = 1; i < n; i++)
+        best = x[i] > best ? x[i] : best;
+    return best;
+}
+
+/* order statistics on a scratch array the caller lets us reorder; m of
+   its n values are non-NaN and sit at the front */
+static double kth_of(double *x, size_t m, size_t k)
+{
+    if (k >= m) return NAN;
+
+    select_kth(x, m, k);
+    return x[k];
+}
+
+static double median_of(double *x, size_t n, size_t m)
+{
+    size_t k = n / 2;
+    double upper = kth_of(x, m, k);
+
+    if (n % 2 == 1 || isnan(upper)) return upper;
+
+    /* after selection the lower middle is the largest element below k */
+    return (max_of(x, k) + upper) / 2.0;
+}
+
+/* nearest-rank: the smallest element with at least p% of the data at or
+   below it */
+static size_t rank_of(double p, size_t n)
+{
+    double r = ceil((p / 100.0) * (double)n);
+    size_t idx = r < 1.0 ? 0 : (size_t)r - 1;
+    return idx < n ? idx : n - 1;
+}
+
+/* Selects every rank in ranks[0..count) (sorted, distinct) within
+   x[left..right]. The middle rank splits the range and the ranks on each
+   side recurse into their own half, so each level of the recursion
+   partitions at most n elements in total and k ranks cost about
+   n log2(k) instead of k n. */
+static void multiselect(double *x, ptrdiff_t left, ptrdiff_t right,
+                        const size_t *ranks, size_t count, int budget)
+{
+    while (count > 0) {
+        size_t mid = count / 2;
+        ptrdiff_t k = (ptrdiff_t)ranks[mid];
+
+        select_range(x, left, right, k, budget);
+
+        /* recurse into the smaller side of the rank list, loop on the other */
+        if (mid < count - mid - 1) {
+            multiselect(x, left, k - 1, ranks, mid, budget);
+            ranks += mid + 1;
+            count -= mid + 1;
+            left = k + 1;
+        } else {
+            multiselect(x, k + 1, right, ranks + mid + 1, count - mid - 1, budget);
+            count = mid;
+            right = k - 1;
+        }
+    }
+}
+
+static int cmp_size(const void *a, const void *b)
+{
+    size_t x = *(const size_t *)a;
+    size_t y = *(const size_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* ===========================================
+                Order statistics
+   =========================================== */
+
+static int check_order_input(const char *fn, const struct Vector *v)
+{
+    if (!v) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (!v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector data pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (v->size == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector size is zero\n", fn);
+        return -1;
+    }
+
+    return 0;
+}
+
+static double *order_copy(const char *fn, const struct Vector *v, size_t *m)
+{
+    double *copy = malloc(sizeof(double) * v->size);
+    if (!copy) {
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: failed to allocate scratch copy\n", fn);
+        return NULL;
+    }
+
+    *m = copy_ordered(copy, v->data, v->size);
+    return copy;
+}
+
+double vec_median(const struct Vector *v)
+{
+    if (check_order_input("vec_median", v) != 0) return -1;
+
+    size_t m;
+    double *copy = order_copy("vec_median", v, &m);
+    if (!copy) return -1;
+
+    double median = median_of(copy, v->size, m);
+
+    free(copy);
+    return median;
+}
+
+double vec_median_inplace(struct Vector *v)
+{
+    if (check_order_input("vec_median_inplace", v) != 0) return -1;
+
+    size_t m = nans_to_back(v->data, v->size);
+    return median_of(v->data, v->size, m);
+}
+
+double vec_percentile(const struct Vector *v, double p)
+{
+    if (check_order_input("vec_percentile", v) != 0) return -1;
+
+    if (p < 0.0 || p > 100.0){
+        errno = ERANGE;
+        fprintf(stderr, "vec_percentile error: p is out of range\n");
+        return -1;
+    }
+
+    size_t m;
+    double *copy = order_copy("vec_percentile", v, &m);
+    if (!copy) return -1;
+
+    double result = kth_of(copy, m, rank_of(p, v->size));
+
+    free(copy);
+    return result;
+}
+
+double vec_percentile_inplace(struct Vector *v, double p)
+{
+    if (check_order_input("vec_percentile_inplace", v) != 0) return -1;
+
+    if (p < 0.0 || p > 100.0){
+        errno = ERANGE;
+        fprintf(stderr, "vec_percentile_inplace error: p is out of range\n");
+        return -1;
+    }
+
+    size_t m = nans_to_back(v->data, v->size);
+    return kth_of(v->data, m, rank_of(p, v->size));
+}
+
+double vec_kth(const struct Vector *v, size_t k)
+{
+    if (check_order_input("vec_kth", v) != 0) return -1;
+
+    if (k >= v->size) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_kth error: k (%zu) is out of range for size %zu\n", k, v->size);
+        return -1;
+    }
+
+    size_t m;
+    double *copy = order_copy("vec_kth", v, &m);
+    if (!copy) return -1;
+
+    double result = kth_of(copy, m, k);
+
+    free(copy);
+    return result;
+}
+
+double vec_kth_inplace(struct Vector *v, size_t k)
+{
+    if (check_order_input("vec_kth_inplace", v) != 0) return -1;
+
+    if (k >= v->size) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_kth_inplace error: k (%zu) is out of range for size %zu\n", k, v->size);
+        return -1;
+    }
+
+    size_t m = nans_to_back(v->data, v->size);
+    return kth_of(v->data, m, k);
+}
+
+/* the rank(s) percentile p reads under method: lo always, hi when the
+   method interpolates between two neighbours (hi == lo otherwise) */
+static void percentile_ranks(double p, size_t n, int method, size_t *lo, size_t *hi, double *frac)
+{
+    double h = (p / 100.0) * (double)(n - 1);
+
+    *frac = 0.0;
+    switch (method) {
+    case VEC_PCT_RANK:
+        *lo = *hi = rank_of(p, n);
+        return;
+    case VEC_PCT_LOWER:
+        *lo = *hi = (size_t)floor(h);
+        return;
+    case VEC_PCT_HIGHER:
+        *lo = *hi = (size_t)ceil(h);
+        return;
+    default:
+        *lo = (size_t)floor(h);
+        *hi = (size_t)ceil(h);
+        *frac = method == VEC_PCT_MIDPOINT ? 0.5 : h - floor(h);
+        return;
+    }
+}
+
+static int percentiles_of(const char *fn, double *x, size_t n, size_t m,
+                          const double *ps, size_t k, double *out, int method)
+{
+    size_t *ranks = malloc(sizeof(size_t) * 2 * k);
+    if (!ranks) {
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: failed to allocate rank list\n", fn);
+        return -1;
+    }
+
+    /* every rank any percentile needs, sorted and deduplicated; ranks on
+       NaNs need no selecting */
+    size_t count = 0;
+    for (size_t j = 0; j < k; j++) {
+        size_t lo, hi;
+        double frac;
+        percentile_ranks(ps[j], n, method, &lo, &hi, &frac);
+        if (lo < m) ranks[count++] = lo;
+        if (hi != lo && hi < m) ranks[count++] = hi;
+    }
+
+    qsort(ranks, count, sizeof(size_t), cmp_size);
+
+    size_t unique = 0;
+    for (size_t j = 0; j < count; j++)
+        if (unique == 0 || ranks[j] != ranks[unique - 1]) ranks[unique++] = ranks[j];
+
+    int budget = 2;
+    for (size_t w = m; w > 1; w >>= 1) budget += 2;
+
+    multiselect(x, 0, (ptrdiff_t)m - 1, ranks, unique, budget);
+    free(ranks);
+
+    for (size_t j = 0; j < k; j++) {
+        size_t lo, hi;
+        double frac;
+        percentile_ranks(ps[j], n, method, &lo, &hi, &frac);
+
+        double a = lo < m ? x[lo] : NAN;
+        double b = hi < m ? x[hi] : NAN;
+        out[j] = hi == lo ? a : a + frac * (b - a);
+    }
+
+    return 0;
+}
+
+static int check_percentiles(const char *fn, const struct Vector *v, const double *ps,
+                             size_t k, double *out, int method)
+{
+    if (check_order_input(fn, v) != 0) return -1;
+
+    if (k > 0 && (!ps || !out)) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: percentile or output array is NULL\n", fn);
+        return -1;
+    }
+
+    if (method < VEC_PCT_RANK || method > VEC_PCT_MIDPOINT) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: unknown method %d\n", fn, method);
+        return -1;
+    }
+
+    for (size_t j = 0; j < k; j++) {
+        if (!(ps[j] >= 0.0 && ps[j] <= 100.0)) {
+            errno = ERANGE;
+            fprintf(stderr, "%s error: p[%zu] = %g is out of range\n", fn, j, ps[j]);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+int vec_percentiles(const struct Vector *v, const double *ps, size_t k, double *out, int method)
+{
+    if (check_percentiles("vec_percentiles", v, ps, k, out, method) != 0) return -1;
+    if (k == 0) return 0;
+
+    size_t m;
+    double *copy = order_copy("vec_percentiles", v, &m);
+    if (!copy) return -1;
+
+    int rc = percentiles_of("vec_percentiles", copy, v->size, m, ps, k, out, method);
+
+    free(copy);
+    return rc;
+}
+
+int vec_percentiles_inplace(struct Vector *v, const double *ps, size_t k, double *out, int method)
+{
+    if (check_percentiles("vec_percentiles_inplace", v, ps, k, out, method) != 0) return -1;
+    if (k == 0) return 0;
+
+    size_t m = nans_to_back(v->data, v->size);
+    return percentiles_of("vec_percentiles_inplace", v->data, v->size, m, ps, k, out, method);
+}
+
+/* ===========================================
+                Sorting
+   =========================================== */
+
+/* LSD radix over the 64-bit key in 11-bit digits: six passes whose
+   counters (16 KiB each) stay in L1 */
+#define RADIX_BITS   11
+#define RADIX_SIZE   (1u << RADIX_BITS)
+#define RADIX_PASSES 6
+
+/* below this the histograms cost more than a comparison sort */
+#define RADIX_MIN 256
+
+/* below this a partition is finished by insertion sort */
+#define INSERTION_MAX 16
+
+#define SIGN_BIT ((uint64_t)1 << 63)
+
+/* Order-preserving map of a double onto an unsigned integer: positives
+   get the sign bit set, negatives are inverted so larger magnitudes come
+   first. NaNs lose their sign and land above +inf. -0 sorts before +0. */
+static inline uint64_t key_of(double x)
+{
+    uint64_t u;
+    memcpy(&u, &x, sizeof u);
+    if (x != x) u &= ~SIGN_BIT;
+    return u ^ (-(u >> 63) | SIGN_BIT);
+}
+
+static inline double double_of(uint64_t k)
+{
+    uint64_t u = (k & SIGN_BIT) ? k ^ SIGN_BIT : ~k;
+    double x;
+    memcpy(&x, &u, sizeof x);
+    return x;
+}
+
+static inline unsigned digit_of(uint64_t k, int pass)
+{
+    return (unsigned)(k >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1);
+}
+
+static void key_sift_down(uint64_t *k, size_t root, size_t n)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= n) return;
+        child += (child + 1 < n && k[child + 1] > k[child]);
+        if (k[child] <= k[root]) return;
+        uint64_t t = k[root];
+        k[root] = k[child];
+        k[child] = t;
+        root = child;
+    }
+}
+
+static void key_heap_sort(uint64_t *k, size_t n)
+{
+    for (size_t i = n / 2; i-- > 0;)
+        key_sift_down(k, i, n);
+    for (size_t end = n; end-- > 1;) {
+        uint64_t t = k[0];
+        k[0] = k[end];
+        k[end] = t;
+        key_sift_down(k, 0, end);
+    }
+}
+
+static void key_insertion_sort(uint64_t *k, size_t n)
+{
+    for (size_t i = 1; i < n; i++) {
+        uint64_t t = k[i];
+        size_t j = i;
+        for (; j > 0 && k[j - 1] > t; j--) k[j] = k[j - 1];
+        k[j] = t;
+    }
+}
+
+/* Introsort with a branch-free Lomuto partition: every element is
+   swapped unconditionally and the boundary advances by the compare
+   result, so random input costs no mispredictions */
+static void key_introsort(uint64_t *k, size_t n, int depth)
+{
+    while (n > INSERTION_MAX) {
+        if (depth-- == 0) {
+            key_heap_sort(k, n);
+            return;
+        }
+
+        /* median of three, parked at the end as the pivot */
+        uint64_t a = k[0], b = k[n / 2], c = k[n - 1];
+        size_t at = (a < b) == (b < c) ? n / 2 : ((b < a) == (a < c) ? 0 : n - 1);
+        uint64_t p = k[at];
+        k[at] = k[n - 1];
+        k[n - 1] = p;
+
+        size_t i = 0;
+        for (size_t j = 0; j < n - 1; j++) {
+            uint64_t t = k[j];
+            size_t lt = t < p;
+            k[j] = k[i];
+            k[i] = t;
+            i += lt;
+        }
+        k[n - 1] = k[i];
+        k[i] = p;
+
+        /* recurse into the smaller side, loop on the larger */
+        if (i < n - i - 1) {
+            key_introsort(k, i, depth);
+            k += i + 1;
+            n -= i + 1;
+        } else {
+            key_introsort(k + i + 1, n - i - 1, depth);
+            n = i;
+        }
+    }
+
+    key_insertion_sort(k, n);
+}
+
+static int log2_floor(size_t n)
+{
+    int r = 0;
+    while (n >>= 1) r++;
+    return r;
+}
+
+/* Counts all six digits in one read of the keys. Returns a bit per pass
+   that actually has to move data: a digit every key shares (the exponent
+   bits of data in a narrow range, say) is skipped. */
+static unsigned radix_histogram(const void *keys, size_t n, size_t (*hist)[RADIX_SIZE])
+{
+    const unsigned char *k = keys;
+    uint64_t key;
+
+    memset(hist, 0, sizeof(size_t) * RADIX_PASSES * RADIX_SIZE);
+
+    for (size_t i = 0; i < n; i++) {
+        memcpy(&key, k + i * sizeof key, sizeof key);
+        for (int p = 0; p < RADIX_PASSES; p++)
+            hist[p][digit_of(key, p)]++;
+    }
+
+    memcpy(&key, k, sizeof key);
+
+    unsigned live = 0;
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        if (hist[p][digit_of(key, p)] == n) continue;
+        live |= 1u << p;
+
+        /* counts to exclusive prefix sums, the first slot of each digit */
+        size_t sum = 0;
+        for (unsigned d = 0; d < RADIX_SIZE; d++) {
+            size_t c = hist[p][d];
+            hist[p][d] = sum;
+            sum += c;
+        }
+    }
+    return live;
+}
+
+int vec_sort(struct Vector *v)
+{
+    if (!v || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sort error: vector or data pointer is NULL\n");
+        return -1;
+    }
+
+    size_t n = v->size;
+    if (n < 2) return 0;
+
+    if (n < RADIX_MIN) {
+        uint64_t keys[RADIX_MIN];
+        for (size_t i = 0; i < n; i++) keys[i] = key_of(v->data[i]);
+        key_introsort(keys, n, 2 * log2_floor(n));
+        for (size_t i = 0; i < n; i++) v->data[i] = double_of(keys[i]);
+        return 0;
+    }
+
+    /* the keys are radix-sorted back and forth between v's own buffer
+       and one scratch buffer, reached through memcpy so the doubles and
+       their integer keys never alias */
+    unsigned char *scratch = vec_aligned_alloc(n * sizeof(uint64_t));
+    size_t (*hist)[RADIX_SIZE] = malloc(sizeof(size_t) * RADIX_PASSES * RADIX_SIZE);
+    if (!scratch || !hist) {
+        vec_aligned_free(scratch);
+        free(hist);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_sort error: failed to allocate radix buffers\n");
+        return -1;
+    }
+
+    unsigned char *src = (unsigned char *)v->data, *dst = scratch;
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key = key_of(v->data[i]);
+        memcpy(src + i * sizeof key, &key, sizeof key);
+    }
+
+    unsigned live = radix_histogram(src, n, hist);
+
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        if (!(live & (1u << p))) continue;
+
+        size_t *slot = hist[p];
+        for (size_t i = 0; i < n; i++) {
+            uint64_t key;
+            memcpy(&key, src + i * sizeof key, sizeof key);
+            memcpy(dst + slot[digit_of(key, p)]++ * sizeof key, &key, sizeof key);
+        }
+
+        unsigned char *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        uint64_t key;
+        memcpy(&key, src + i * sizeof key, sizeof key);
+        v->data[i] = double_of(key);
+    }
+
+    free(hist);
+    vec_aligned_free(scratch);
+    return 0;
+}
+
+/* Stable: equal values keep their original order, in both paths */
+int vec_argsort(const struct Vector *v, int *indices)
+{
+    if (!v || !indices || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_argsort error: vector, data or index pointer is NULL\n");
+        return -1;
+    }
+
+    size_t n = v->size;
+    if (n > (size_t)INT_MAX) {
+        errno = EOVERFLOW;
+        fprintf(stderr, "vec_argsort error: size %zu does not fit int indices\n", n);
+        return -1;
+    }
+
+    if (n < RADIX_MIN) {
+        uint64_t keys[RADIX_MIN];
+        for (size_t i = 0; i < n; i++) {
+            uint64_t key = key_of(v->data[i]);
+            size_t j = i;
+            for (; j > 0 && keys[j - 1] > key; j--) {
+                keys[j] = keys[j - 1];
+                indices[j] = indices[j - 1];
+            }
+            keys[j] = key;
+            indices[j] = (int)i;
+        }
+        return 0;
+    }
+
+    uint64_t *keys = vec_aligned_alloc(2 * n * sizeof(uint64_t));
+    int *idx = vec_aligned_alloc(n * sizeof(int));
+    size_t (*hist)[RADIX_SIZE] = malloc(sizeof(size_t) * RADIX_PASSES * RADIX_SIZE);
+    if (!keys || !idx || !hist) {
+        vec_aligned_free(keys);
+        vec_aligned_free(idx);
+        free(hist);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_argsort error: failed to allocate radix buffers\n");
+        return -1;
+    }
+
+    uint64_t *src = keys, *dst = keys + n;
+    int *isrc = indices, *idst = idx;
+    for (size_t i = 0; i < n; i++) {
+        src[i] = key_of(v->data[i]);
+        isrc[i] = (int)i;
+    }
+
+    unsigned live = radix_histogram(src, n, hist);
+
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        if (!(live & (1u << p))) continue;
+
+        size_t *slot = hist[p];
+        for (size_t i = 0; i < n; i++) {
+            size_t at = slot[digit_of(src[i], p)]++;
+            dst[at] = src[i];
+            idst[at] = isrc[i];
+        }
+
+        uint64_t *t = src;
+        src = dst;
+        dst = t;
+        int *it = isrc;
+        isrc = idst;
+        idst = it;
+    }
+
+    if (isrc != indices) memcpy(indices, isrc, n * sizeof(int));
+
+    free(hist);
+    vec_aligned_free(idx);
+    vec_aligned_free(keys);
+    return 0;
+}
+
+/* ===========================================
+                Parallel sorting
+   =========================================== */
+
+/* samples per bucket when picking splitters */
+#define SAMPLE_OVERSAMPLE 64
+
+/* Sorts keys[0..n) and, when idx is given, carries the indices along.
+   Stable. tmp / itmp are scratch of the same length; returns 1 when the
+   result ended up in the scratch buffers. */
+static int radix_sort_range(uint64_t *keys, uint64_t *tmp, int64_t *idx, int64_t *itmp,
+                            size_t n, size_t (*hist)[RADIX_SIZE])
+{
+    if (n < RADIX_MIN) {
+        if (!idx) {
+            key_introsort(keys, n, 2 * log2_floor(n));
+            return 0;
+        }
+        for (size_t i = 1; i < n; i++) {
+            uint64_t key = keys[i];
+            int64_t at = idx[i];
+            size_t j = i;
+            for (; j > 0 && keys[j - 1] > key; j--) {
+                keys[j] = keys[j - 1];
+                idx[j] = idx[j - 1];
+            }
+            keys[j] = key;
+            idx[j] = at;
+        }
+        return 0;
+    }
+
+    uint64_t *src = keys, *dst = tmp;
+    int64_t *isrc = idx, *idst = itmp;
+    int swapped = 0;
+    unsigned live = radix_histogram(src, n, hist);
+
+    for (int p = 0; p < RADIX_PASSES; p++) {
+        if (!(live & (1u << p))) continue;
+
+        size_t *slot = hist[p];
+        for (size_t i = 0; i < n; i++) {
+            size_t at = slot[digit_of(src[i], p)]++;
+            dst[at] = src[i];
+            if (isrc) idst[at] = isrc[i];
+        }
+
+        uint64_t *t = src;
+        src = dst;
+        dst = t;
+        int64_t *it = isrc;
+        isrc = idst;
+        idst = it;
+        swapped ^= 1;
+    }
+
+    return swapped;
+}
+
+/* Sample sort. Elements are ranked by (key, original index), which is a
+   strict order even with duplicates, so the buckets stay balanced on
+   constant input and the output does not depend on the thread count:
+     1. keys from the doubles, one chunk per thread
+     2. T - 1 splitters from evenly spaced samples (no randomness)
+     3. per-chunk bucket counts, then a stable scatter into buckets
+     4. each bucket radix-sorted on its own thread, written back */
+struct SortShared{
+    const double *data;
+    size_t n;
+    int threads;
+    uint64_t *keys, *tmp;
+    int64_t *idx, *itmp;            /* NULL for a plain sort */
+    uint64_t split_key[VEC_MAX_THREADS];
+    size_t split_at[VEC_MAX_THREADS];
+    size_t *offsets;                /* [chunk][bucket] scatter positions */
+    size_t bucket_start[VEC_MAX_THREADS + 1];
+    double *out_values;
+    int64_t *out_indices;
+    size_t *hist;                   /* [bucket][pass][digit] radix counts */
+};
+
+struct SortTask{
+    struct SortShared *sh;
+    int id;
+    int phase;
+};
+
+static inline int bucket_of(const struct SortShared *sh, uint64_t key, size_t at)
+{
+    int lo = 0, hi = sh->threads - 1;
+
+    /* first splitter above (key, at); the last bucket has none */
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int below = key < sh->split_key[mid] || (key == sh->split_key[mid] && at < sh->split_at[mid]);
+        if (below) hi = mid;
+        else       lo = mid + 1;
+    }
+    return lo;
+}
+
+static void *sort_worker(void *arg)
+{
+    struct SortTask *task = arg;
+    struct SortShared *sh = task->sh;
+    int T = sh->threads, t = task->id;
+    size_t begin = sh->n * (size_t)t / (size_t)T;
+    size_t end = sh->n * (size_t)(t + 1) / (size_t)T;
+
+    switch (task->phase) {
+    case 0:
+        for (size_t i = begin; i < end; i++)
+            sh->keys[i] = key_of(sh->data[i]);
+        break;
+
+    case 1: {
+        size_t *count = sh->offsets + (size_t)t * (size_t)T;
+        for (size_t i = begin; i < end; i++)
+            count[bucket_of(sh, sh->keys[i], i)]++;
+        break;
+    }
+
+    case 2: {
+        size_t *slot = sh->offsets + (size_t)t * (size_t)T;
+        for (size_t i = begin; i < end; i++) {
+            size_t at = slot[bucket_of(sh, sh->keys[i], i)]++;
+            sh->tmp[at] = sh->keys[i];
+            if (sh->idx) sh->itmp[at] = (int64_t)i;
+        }
+        break;
+    }
+
+    default: {
+        size_t start = sh->bucket_start[t], len = sh->bucket_start[t + 1] - start;
+        size_t (*hist)[RADIX_SIZE] =
+            (size_t (*)[RADIX_SIZE])(sh->hist + (size_t)t * RADIX_PASSES * RADIX_SIZE);
+
+        /* the bucket sits in tmp; keys is free scratch for this range */
+        uint64_t *k = sh->tmp + start, *ks = sh->keys + start;
+        int64_t *ix = sh->idx ? sh->itmp + start : NULL, *ixs = sh->idx ? sh->idx + start : NULL;
+
+        if (radix_sort_range(k, ks, ix, ixs, len, hist)) {
+            k = ks;
+            ix = ixs;
+        }
+
+        if (sh->out_values)
+            for (size_t i = 0; i < len; i++) sh->out_values[start + i] = double_of(k[i]);
+        if (sh->out_indices && ix != sh->out_indices + start)
+            memcpy(sh->out_indices + start, ix, len * sizeof(int64_t));
+        break;
+    }
+    }
+
+    return NULL;
+}
+
+static int cmp_sample(const void *a, const void *b)
+{
+    const uint64_t *x = a, *y = b;
+    if (x[0] != y[0]) return x[0] < y[0] ? -1 : 1;
+    return (x[1] > y[1]) - (x[1] < y[1]);
+}
+
+static int parallel_sort(const char *fn, struct SortShared *sh)
+{
+    int T = sh->threads;
+    size_t n = sh->n;
+    struct SortTask tasks[VEC_MAX_THREADS];
+
+    /* everything the phases need is allocated up front: once the last
+       phase starts writing the output, nothing may fail halfway */
+    sh->offsets = calloc((size_t)T * (size_t)T, sizeof(size_t));
+    sh->hist = malloc((size_t)T * RADIX_PASSES * RADIX_SIZE * sizeof(size_t));
+    size_t samples = (size_t)T * SAMPLE_OVERSAMPLE;
+    uint64_t (*sample)[2] = malloc(samples * sizeof *sample);
+    if (!sh->offsets || !sh->hist || !sample) {
+        free(sh->offsets);
+        free(sh->hist);
+        free(sample);
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: failed to allocate sample buffers\n", fn);
+        return -1;
+    }
+
+    for (int t = 0; t < T; t++) tasks[t] = (struct SortTask){ sh, t, 0 };
+    vec_run_parallel(sort_worker, tasks, sizeof tasks[0], T);
+
+    for (size_t j = 0; j < samples; j++) {
+        size_t at = (2 * j + 1) * n / (2 * samples);
+        sample[j][0] = sh->keys[at];
+        sample[j][1] = at;
+    }
+    qsort(sample, samples, sizeof *sample, cmp_sample);
+    for (int b = 0; b + 1 < T; b++) {
+        sh->split_key[b] = sample[(size_t)(b + 1) * SAMPLE_OVERSAMPLE][0];
+        sh->split_at[b] = (size_t)sample[(size_t)(b + 1) * SAMPLE_OVERSAMPLE][1];
+    }
+    free(sample);
+
+    for (int t = 0; t < T; t++) tasks[t].phase = 1;
+    vec_run_parallel(sort_worker, tasks, sizeof tasks[0], T);
+
+    /* counts to scatter positions: bucket-major, chunk order inside a
+       bucket, which keeps the scatter stable */
+    size_t pos = 0;
+    for (int b = 0; b < T; b++) {
+        sh->bucket_start[b] = pos;
+        for (int t = 0; t < T; t++) {
+            size_t c = sh->offsets[(size_t)t * (size_t)T + (size_t)b];
+            sh->offsets[(size_t)t * (size_t)T + (size_t)b] = pos;
+            pos += c;
+        }
+    }
+    sh->bucket_start[T] = pos;
+
+    for (int t = 0; t < T; t++) tasks[t].phase = 2;
+    vec_run_parallel(sort_worker, tasks, sizeof tasks[0], T);
+
+    for (int t = 0; t < T; t++) tasks[t].phase = 3;
+    vec_run_parallel(sort_worker, tasks, sizeof tasks[0], T);
+
+    free(sh->offsets);
+    free(sh->hist);
+    return 0;
+}
+
+int vec_sort_parallel(struct Vector *v, int nthreads)
+{
+    if (!v || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_sort_parallel error: vector or data pointer is NULL\n");
+        return -1;
+    }
+
+    int T = vec_parallel_threads(nthreads, v->size);
+    if (T == 1) return vec_sort(v);
+
+    struct SortShared *sh = calloc(1, sizeof *sh);
+    uint64_t *keys = vec_aligned_alloc(2 * v->size * sizeof(uint64_t));
+    if (!sh || !keys) {
+        free(sh);
+        vec_aligned_free(keys);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_sort_parallel error: failed to allocate key buffers\n");
+        return -1;
+    }
+
+    sh->data = v->data;
+    sh->n = v->size;
+    sh->threads = T;
+    sh->keys = keys;
+    sh->tmp = keys + v->size;
+    sh->out_values = v->data;
+
+    int rc = parallel_sort("vec_sort_parallel", sh);
+
+    vec_aligned_free(keys);
+    free(sh);
+    return rc;
+}
+
+int vec_argsort_parallel(const struct Vector *v, int64_t *indices, int nthreads)
+{
+    if (!v || !indices || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_argsort_parallel error: vector, data or index pointer is NULL\n");
+        return -1;
+    }
+
+    /* the index buffers double as the caller's output */
+    int T = vec_parallel_threads(nthreads, v->size);
+    size_t n = v->size;
+
+    struct SortShared *sh = calloc(1, sizeof *sh);
+    uint64_t *keys = vec_aligned_alloc(2 * n * sizeof(uint64_t));
+    int64_t *itmp = vec_aligned_alloc(n * sizeof(int64_t));
+    if (!sh || !keys || !itmp) {
+        free(sh);
+        vec_aligned_free(keys);
+        vec_aligned_free(itmp);
+        errno = ENOMEM;
+        fprintf(stderr, "vec_argsort_parallel error: failed to allocate key buffers\n");
+        return -1;
+    }
+
+    sh->data = v->data;
+    sh->n = n;
+    sh->threads = T;
+    sh->keys = keys;
+    sh->tmp = keys + n;
+    sh->idx = indices;
+    sh->itmp = itmp;
+    sh->out_indices = indices;
+
+    int rc = 0;
+    if (T == 1) {
+        /* one bucket: the scatter would be a plain copy */
+        size_t (*hist)[RADIX_SIZE] = malloc(sizeof(size_t) * RADIX_PASSES * RADIX_SIZE);
+        if (!hist) {
+            errno = ENOMEM;
+            fprintf(stderr, "vec_argsort_parallel error: failed to allocate radix buffers\n");
+            rc = -1;
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                keys[i] = key_of(v->data[i]);
+                indices[i] = (int64_t)i;
+            }
+            if (radix_sort_range(keys, keys + n, indices, itmp, n, hist))
+                memcpy(indices, itmp, n * sizeof(int64_t));
+            free(hist);
+        }
+    } else {
+        rc = parallel_sort("vec_argsort_parallel", sh);
+    }
+
+    vec_aligned_free(itmp);
+    vec_aligned_free(keys);
+    free(sh);
+    return rc;
+}
+
+/* ===========================================
+                Top-k / bottom-k
+   =========================================== */
+
+/* a candidate for the k best; "best" is the largest value for top-k and
+   the smallest for bottom-k, ties going to the lower index, so the
+   answer is unique and independent of how the work was split */
+struct TopCand{
+    double value;
+    size_t index;
+};
+
+static inline int beats(struct TopCand a, struct TopCand b, int largest)
+{
+    if (a.value != b.value) return largest ? a.value > b.value : a.value < b.value;
+    return a.index < b.index;
+}
+
+/* heap with the weakest candidate at the root */
+static void cand_sift_down(struct TopCand *h, size_t root, size_t n, int largest)
+{
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= n) return;
+        if (child + 1 < n && beats(h[child], h[child + 1], largest)) child++;
+        if (!beats(h[root], h[child], largest)) return;
+        struct TopCand t = h[root];
+        h[root] = h[child];
+        h[child] = t;
+        root = child;
+    }
+}
+
+static void cand_push(struct TopCand *h, size_t *count, size_t k, struct TopCand c, int largest)
+{
+    if (*count < k) {
+        /* sift up */
+        size_t at = (*count)++;
+        while (at > 0) {
+            size_t parent = (at - 1) / 2;
+            if (!beats(h[parent], c, largest)) break;
+            h[at] = h[parent];
+            at = parent;
+        }
+        h[at] = c;
+    } else if (beats(c, h[0], largest)) {
+        h[0] = c;
+        cand_sift_down(h, 0, k, largest);
+    }
+}
+
+/* Scans x[0..n) (global indices from base) into the heap. Once the heap
+   is full only elements strictly beyond the weakest kept value can get
+   in (an equal one has a higher index and loses), so the dispatched
+   threshold scan skips everything else without a per-element branch. */
+static void topk_scan(const double *x, size_t n, size_t base, size_t k, int largest,
+                      struct TopCand *h, size_t *count)
+{
+    const struct VecKernels *kern = vec_kernels();
+    size_t i = 0;
+
+    for (; i < n && *count < k; i++)
+        if (x[i] == x[i]) cand_push(h, count, k, (struct TopCand){ x[i], base + i }, largest);
+
+    while (i < n) {
+        double t = h[0].value;
+        i += largest ? kern->find_above(x + i, n - i, t) : kern->find_below(x + i, n - i, t);
+        if (i >= n) break;
+
+        h[0] = (struct TopCand){ x[i], base + i };
+        cand_sift_down(h, 0, k, largest);
+        i++;
+    }
+}
+
+/* heap to best-first output; missing slots are NaN / SIZE_MAX */
+static void topk_emit(struct TopCand *h, size_t count, size_t k, int largest,
+                      double *values, size_t *indices)
+{
+    for (size_t end = count; end > 1; end--) {
+        struct TopCand t = h[0];
+        h[0] = h[end - 1];
+        h[end - 1] = t;
+        cand_sift_down(h, 0, end - 1, largest);
+    }
+
+    for (size_t j = 0; j < k; j++) {
+        if (values)  values[j] = j < count ? h[j].value : NAN;
+        if (indices) indices[j] = j < count ? h[j].index : SIZE_MAX;
+    }
+}
+
+struct TopkTask{
+    const double *x;
+    size_t n, k;
+    int threads, id, largest;
+    struct TopCand *heap;           /* k slots per thread */
+    size_t count;
+};
+
+static void *topk_worker(void *arg)
+{
+    struct TopkTask *task = arg;
+    size_t begin = task->n * (size_t)task->id / (size_t)task->threads;
+    size_t end = task->n * (size_t)(task->id + 1) / (size_t)task->threads;
+
+    topk_scan(task->x + begin, end - begin, begin, task->k, task->largest, task->heap, &task->count);
+    return NULL;
+}
+
+static int select_k(const char *fn, const struct Vector *v, size_t k, double *values,
+                    size_t *indices, int largest, int nthreads)
+{
+    if (!v || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector or data pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (k == 0) return 0;
+
+    if (!values && !indices) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: both outputs are NULL\n", fn);
+        return -1;
+    }
+
+    /* no more candidates than elements can exist */
+    size_t slots = k < v->size ? k : v->size;
+    int T = nthreads == 1 ? 1 : vec_parallel_threads(nthreads, v->size);
+
+    struct TopCand *heaps = malloc(((size_t)T + 1) * (slots ? slots : 1) * sizeof *heaps);
+    struct TopkTask *tasks = calloc((size_t)T, sizeof *tasks);
+    if (!heaps || !tasks) {
+        free(heaps);
+        free(tasks);
+        errno = ENOMEM;
+        fprintf(stderr, "%s error: failed to allocate candidate heaps\n", fn);
+        return -1;
+    }
+
+    for (int t = 0; t < T; t++)
+        tasks[t] = (struct TopkTask){ v->data, v->size, slots, T, t, largest,
+                                      heaps + (size_t)t * slots, 0 };
+    vec_run_parallel(topk_worker, tasks, sizeof tasks[0], T);
+
+    /* each thread's survivors compete once more for the final k */
+    struct TopCand *final = tasks[0].heap;
+    size_t count = tasks[0].count;
+    if (T > 1) {
+        final = heaps + (size_t)T * slots;
+        count = 0;
+        for (int t = 0; t < T; t++)
+            for (size_t j = 0; j < tasks[t].count; j++)
+                cand_push(final, &count, slots, tasks[t].heap[j], largest);
+    }
+
+    topk_emit(final, count, k, largest, values, indices);
+
+    free(tasks);
+    free(heaps);
+    return 0;
+}
+
+int vec_topk(const struct Vector *v, size_t k, double *values, size_t *indices)
+{
+    return select_k("vec_topk", v, k, values, indices, 1, 1);
+}
+
+int vec_bottomk(const struct Vector *v, size_t k, double *values, size_t *indices)
+{
+    return select_k("vec_bottomk", v, k, values, indices, 0, 1);
+}
+
+int vec_topk_parallel(const struct Vector *v, size_t k, double *values, size_t *indices, int nthreads)
+{
+    return select_k("vec_topk_parallel", v, k, values, indices, 1, nthreads);
+}
+
+int vec_bottomk_parallel(const struct Vector *v, size_t k, double *values, size_t *indices, int nthreads)
+{
+    return select_k("vec_bottomk_parallel", v, k, values, indices, 0, nthreads);
+}
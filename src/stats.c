@@ -0,0 +1,255 @@
+/* stats.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+/* elements per describe block: 16 KiB, so the kernel's second sweep over
+   the block is served from L1 */
+#define DESCRIBE_BLOCK 2048
+
+/* ===========================================
+                Describe
+   =========================================== */
+
+int vec_describe(const struct Vector *v, struct VecStats *out)
+{
+    if (!v || !out || (!v->data && v->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_describe error: vector or output pointer is NULL\n");
+        return -1;
+    }
+
+    const struct VecKernels *k = vec_kernels();
+
+    size_t n = 0, argmin = SIZE_MAX, argmax = SIZE_MAX;
+    double mean = 0.0, m2 = 0.0, sum = 0.0, l1 = 0.0, norm = 0.0;
+    double min_value = INFINITY, max_value = -INFINITY;
+
+    for (size_t off = 0; off < v->size; off += DESCRIBE_BLOCK) {
+        size_t len = v->size - off < DESCRIBE_BLOCK ? v->size - off : DESCRIBE_BLOCK;
+        struct VecBlockStats b;
+
+        k->describe(v->data + off, len, &b);
+        if (b.count == 0) continue;
+
+        /* Chan et al. pairwise update of (n, mean, M2), as in vec_stream_stats */
+        double block_mean = b.sum / (double)b.count;
+        double delta = block_mean - mean;
+        size_t total = n + b.count;
+        mean += delta * (double)b.count / (double)total;
+        m2 += b.m2 + delta * delta * (double)n * (double)b.count / (double)total;
+        n = total;
+
+        sum += b.sum;
+        l1 += b.l1;
+        norm = hypot(norm, sqrt(b.l2sq));
+
+        /* strict compares: an equal value in a later block keeps the earlier index */
+        if (b.argmin != SIZE_MAX && b.min < min_value) {
+            min_value = b.min;
+            argmin = off + b.argmin;
+        }
+        if (b.argmax != SIZE_MAX && b.max > max_value) {
+            max_value = b.max;
+            argmax = off + b.argmax;
+        }
+    }
+
+    /* every non-NaN element sat on the starting infinity, so nothing beat
+       it; the answer is that infinity at the first non-NaN position */
+    if (n > 0 && (argmin == SIZE_MAX || argmax == SIZE_MAX)) {
+        size_t first = 0;
+        while (isnan(v->data[first])) first++;
+        if (argmin == SIZE_MAX) argmin = first;
+        if (argmax == SIZE_MAX) argmax = first;
+    }
+
+    out->count = n;
+    out->nan_count = v->size - n;
+    out->sum = sum;
+    out->mean = n ? mean : NAN;
+    out->var = n ? m2 / (double)n : NAN;
+    out->min = n ? min_value : NAN;
+    out->max = n ? max_value : NAN;
+    out->argmin = argmin;
+    out->argmax = argmax;
+    out->norm1 = l1;
+    out->norm2 = norm;
+
+    return 0;
+}
+
+/* ===========================================
+                Moments
+   =========================================== */
+
+/* elements per moments block: a block of both inputs fills half of L1 */
+#define MOMENTS_BLOCK 1024
+
+void vec_moments_init(struct VecMoments *m)
+{
+    memset(m, 0, sizeof *m);
+}
+
+/* Chan et al. pairwise update, extended to the cross-product term */
+void vec_moments_merge(struct VecMoments *dst, const struct VecMoments *src)
+{
+    if (src->count == 0) return;
+    if (dst->count == 0) {
+        *dst = *src;
+        return;
+    }
+
+    double n1 = (double)dst->count, n2 = (double)src->count;
+    double n = n1 + n2;
+    double da = src->mean_a - dst->mean_a;
+    double db = src->mean_b - dst->mean_b;
+    double w = n1 * n2 / n;
+
+    dst->m2_a += src->m2_a + da * da * w;
+    dst->m2_b += src->m2_b + db * db * w;
+    dst->c_ab += src->c_ab + da * db * w;
+    dst->mean_a += da * n2 / n;
+    dst->mean_b += db * n2 / n;
+    dst->count += src->count;
+}
+
+/* Block moments combined under one VEC_SUM_* mode. FAST merges them in
+   order; PAIRWISE pushes them through a binary counter so every merge
+   joins two equal-sized halves; KAHAN merges in order but carries each
+   running mean and sum of squares as a Neumaier pair. */
+struct MomentsAcc{
+    int mode;
+    struct VecMoments run;
+    double comp[5];                 /* mean_a, mean_b, m2_a, m2_b, c_ab */
+    struct VecMoments part[64];
+    uint64_t levels;
+};
+
+/* Chan update against the compensated running totals */
+static void merge_compensated(struct MomentsAcc *acc, const struct VecMoments *src)
+{
+    struct VecMoments *dst = &acc->run;
+    double *c = acc->comp;
+
+    if (dst->count == 0) {
+        *dst = *src;
+        return;
+    }
+
+    double n1 = (double)dst->count, n2 = (double)src->count;
+    double n = n1 + n2;
+    double da = (src->mean_a - dst->mean_a) - c[0];
+    double db = (src->mean_b - dst->mean_b) - c[1];
+    double w = n1 * n2 / n;
+
+    vec_neumaier_add(&dst->m2_a, &c[2], src->m2_a + da * da * w);
+    vec_neumaier_add(&dst->m2_b, &c[3], src->m2_b + db * db * w);
+    vec_neumaier_add(&dst->c_ab, &c[4], src->c_ab + da * db * w);
+    vec_neumaier_add(&dst->mean_a, &c[0], da * n2 / n);
+    vec_neumaier_add(&dst->mean_b, &c[1], db * n2 / n);
+    dst->count += src->count;
+}
+
+static void moments_push(struct MomentsAcc *acc, struct VecMoments *block)
+{
+    switch (acc->mode) {
+    case VEC_SUM_PAIRWISE: {
+        int level = 0;
+        while (acc->levels & ((uint64_t)1 << level)) {
+            vec_moments_merge(block, &acc->part[level]);
+            acc->levels &= ~((uint64_t)1 << level);
+            level++;
+        }
+        acc->part[level] = *block;
+        acc->levels |= (uint64_t)1 << level;
+        break;
+    }
+
+    case VEC_SUM_KAHAN:
+        merge_compensated(acc, block);
+        break;
+
+    default:
+        vec_moments_merge(&acc->run, block);
+        break;
+    }
+}
+
+static void moments_result(struct MomentsAcc *acc, struct VecMoments *out)
+{
+    vec_moments_init(out);
+
+    switch (acc->mode) {
+    case VEC_SUM_PAIRWISE:
+        /* smallest partials first */
+        for (int level = 0; level < 64; level++)
+            if (acc->levels & ((uint64_t)1 << level)) vec_moments_merge(out, &acc->part[level]);
+        break;
+
+    case VEC_SUM_KAHAN:
+        *out = acc->run;
+        out->mean_a += acc->comp[0];
+        out->mean_b += acc->comp[1];
+        out->m2_a += acc->comp[2];
+        out->m2_b += acc->comp[3];
+        out->c_ab += acc->comp[4];
+        break;
+
+    default:
+        *out = acc->run;
+        break;
+    }
+}
+
+int vec_moments_update(struct VecMoments *m, const struct Vector *a, const struct Vector *b)
+{
+    if (!m || !a || (!a->data && a->size > 0) || (b && !b->data && b->size > 0)) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_moments_update error: state or vector pointer is NULL\n");
+        return -1;
+    }
+
+    if (b && b->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_moments_update error: vector sizes differ (%zu vs %zu)\n",
+                a->size, b->size);
+        return -1;
+    }
+
+    const struct VecKernels *k = vec_kernels();
+    struct MomentsAcc acc;
+    struct VecMoments block;
+
+    memset(&acc, 0, sizeof acc);
+    acc.mode = vec_get_sum_mode();
+
+    for (size_t off = 0; off < a->size; off += MOMENTS_BLOCK) {
+        size_t len = a->size - off < MOMENTS_BLOCK ? a->size - off : MOMENTS_BLOCK;
+
+        k->moments(a->data + off, b ? b->data + off : NULL, len, &block);
+        moments_push(&acc, &block);
+    }
+
+    moments_result(&acc, &block);
+    vec_moments_merge(m, &block);
+    return 0;
+}
+
+double vec_moments_var(const struct VecMoments *m)
+{
+    return m->count ? m->m2_a / (double)m->count : NAN;
+}
+
+double vec_moments_cov(const struct VecMoments *m)
+{
+    return m->count ? m->c_ab / (double)m->count : NAN;
+}
+
+double vec_moments_corr(const struct VecMoments *m)
+{
+    if (m->count == 0 || m->m2_a == 0.0 || m->m2_b == 0.0) return NAN;
+
+    return m->c_ab / (sqrt(m->m2_a) * sqrt(m->m2_b));
+}
@@ -0,0 +1,444 @@
+/* stream.c */
+
+/* read() is POSIX, hidden by -std=c11 */
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
+#include "libs.h"
+#include "vector.h"
+
+#include <pthread.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/* elements per chunk when the caller passes 0 (8 MiB of doubles) */
+#define STREAM_DEFAULT_CHUNK ((size_t)1 << 20)
+
+/* ===========================================
+                Built-in sources
+   =========================================== */
+
+static size_t file_next(void *ctx, double *buf, size_t cap)
+{
+    FILE *f = ctx;
+    size_t got = fread(buf, sizeof(double), cap, f);
+
+    if (got < cap && ferror(f)) return VEC_CHUNK_ERROR;
+    return got;
+}
+
+struct VecChunkSource vec_source_file(FILE *f)
+{
+    struct VecChunkSource src = { file_next, f, NULL };
+    return src;
+}
+
+#if !defined(_WIN32)
+
+static size_t fd_next(void *ctx, double *buf, size_t cap)
+{
+    int fd = (int)(intptr_t)ctx;
+    unsigned char *dst = (unsigned char *)buf;
+    size_t want = cap * sizeof(double);
+    size_t have = 0;
+
+    /* read() may stop short of a whole double, keep going until it doesn't */
+    while (have < want) {
+        ssize_t n = read(fd, dst + have, want - have);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return VEC_CHUNK_ERROR;
+        }
+        if (n == 0) break;
+        have += (size_t)n;
+    }
+
+    if (have % sizeof(double) != 0) {
+        errno = EIO;
+        return VEC_CHUNK_ERROR;
+    }
+
+    return have / sizeof(double);
+}
+
+struct VecChunkSource vec_source_fd(int fd)
+{
+    struct VecChunkSource src = { fd_next, (void *)(intptr_t)fd, NULL };
+    return src;
+}
+
+#endif
+
+/* the copying form, for callers that drive the source themselves */
+static size_t vector_next(void *ctx, double *buf, size_t cap)
+{
+    struct VecVectorCursor *cur = ctx;
+    size_t left = cur->v->size - cur->pos;
+    size_t n = left < cap ? left : cap;
+
+    memcpy(buf, cur->v->data + cur->pos, n * sizeof(double));
+    cur->pos += n;
+
+    return n;
+}
+
+static const double *vector_window(void *ctx, size_t cap, size_t *got)
+{
+    struct VecVectorCursor *cur = ctx;
+    size_t left = cur->v->size - cur->pos;
+    const double *at = cur->v->data ? cur->v->data + cur->pos : NULL;
+
+    *got = left < cap ? left : cap;
+    cur->pos += *got;
+    return at;
+}
+
+struct VecChunkSource vec_source_vector(struct VecVectorCursor *cursor, const struct Vector *v)
+{
+    cursor->v = v;
+    cursor->pos = 0;
+
+    struct VecChunkSource src = { vector_next, cursor, vector_window };
+    return src;
+}
+
+
+/* ===========================================
+                Double-buffered reader
+   =========================================== */
+
+struct Fill {
+    struct VecChunkSource src;
+    double *buf;    /* staging buffer, NULL for a window source */
+    const double *data;     /* the chunk: buf, or the source's own memory */
+    size_t cap;
+    size_t got;     /* elements filled, or VEC_CHUNK_ERROR */
+    int err;
+};
+
+/* keeps calling the source until the buffer is full or it runs dry, so
+   generators that hand out ragged pieces still yield full chunks */
+static void fill_chunk(struct Fill *f)
+{
+    f->got = 0;
+
+    if (f->src.window) {
+        f->data = f->src.window(f->src.ctx, f->cap, &f->got);
+        return;
+    }
+
+    f->data = f->buf;
+    while (f->got < f->cap) {
+        size_t n = f->src.next(f->src.ctx, f->buf + f->got, f->cap - f->got);
+        if (n == VEC_CHUNK_ERROR) {
+            f->got = VEC_CHUNK_ERROR;
+            f->err = errno ? errno : EIO;
+            break;
+        }
+        if (n == 0) break;
+        f->got += n;
+    }
+}
+
+/* One helper thread per pass, started at the first prefetch: it waits
+   for a request, fills that buffer and reports back. */
+struct Reader {
+    struct Fill fill[2];
+    int cur;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int started;    /* thread is running */
+    int request;    /* buffer index for the thread to fill, or -1 */
+    int busy;       /* a request is queued or being filled */
+    int quit;
+};
+
+static void *reader_thread(void *arg)
+{
+    struct Reader *r = arg;
+
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (r->request < 0 && !r->quit)
+            pthread_cond_wait(&r->cond, &r->lock);
+        if (r->quit) break;
+
+        int k = r->request;
+        r->request = -1;
+        pthread_mutex_unlock(&r->lock);
+
+        fill_chunk(&r->fill[k]);
+
+        pthread_mutex_lock(&r->lock);
+        r->busy = 0;
+        pthread_cond_broadcast(&r->cond);
+    }
+    pthread_mutex_unlock(&r->lock);
+
+    return NULL;
+}
+
+static int reader_open(struct Reader *r, struct VecChunkSource src, size_t chunk)
+{
+    memset(r, 0, sizeof *r);
+    r->request = -1;
+
+    for (int k = 0; k < 2; k++) {
+        r->fill[k].src = src;
+        r->fill[k].cap = chunk;
+        if (src.window) continue;
+
+        r->fill[k].buf = vec_aligned_alloc(chunk * sizeof(double));
+        if (!r->fill[k].buf) {
+            vec_aligned_free(r->fill[0].buf);
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+
+    fill_chunk(&r->fill[0]);
+    return 0;
+}
+
+/* starts fetching the chunk after the current one in the background */
+static void reader_prefetch(struct Reader *r)
+{
+    struct Fill *next = &r->fill[r->cur ^ 1];
+
+    /* an in-memory window costs nothing to hand out */
+    if (next->src.window) {
+        fill_chunk(next);
+        return;
+    }
+
+    if (!r->started) {
+        if (pthread_mutex_init(&r->lock, NULL) != 0) {
+            fill_chunk(next);
+            return;
+        }
+        if (pthread_cond_init(&r->cond, NULL) != 0) {
+            pthread_mutex_destroy(&r->lock);
+            fill_chunk(next);
+            return;
+        }
+        if (pthread_create(&r->thread, NULL, reader_thread, r) != 0) {
+            pthread_cond_destroy(&r->cond);
+            pthread_mutex_destroy(&r->lock);
+            fill_chunk(next);   /* no thread available, read synchronously */
+            return;
+        }
+        r->started = 1;
+    }
+
+    pthread_mutex_lock(&r->lock);
+    r->request = r->cur ^ 1;
+    r->busy = 1;
+    pthread_cond_broadcast(&r->cond);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static void reader_wait(struct Reader *r)
+{
+    if (!r->started) return;
+
+    pthread_mutex_lock(&r->lock);
+    while (r->busy)
+        pthread_cond_wait(&r->cond, &r->lock);
+    pthread_mutex_unlock(&r->lock);
+}
+
+static void reader_advance(struct Reader *r)
+{
+    reader_wait(r);
+    r->cur ^= 1;
+}
+
+static void reader_close(struct Reader *r)
+{
+    if (r->started) {
+        reader_wait(r);
+
+        pthread_mutex_lock(&r->lock);
+        r->quit = 1;
+        pthread_cond_broadcast(&r->cond);
+        pthread_mutex_unlock(&r->lock);
+
+        pthread_join(r->thread, NULL);
+        pthread_cond_destroy(&r->cond);
+        pthread_mutex_destroy(&r->lock);
+    }
+
+    vec_aligned_free(r->fill[0].buf);
+    vec_aligned_free(r->fill[1].buf);
+}
+
+
+/* ===========================================
+                Streaming reductions
+   =========================================== */
+
+/* chunks go to CBLAS as an int and are allocated in bytes */
+static int check_chunk(const char *fn, size_t chunk)
+{
+    if (chunk > (size_t)INT_MAX || chunk > SIZE_MAX / sizeof(double)) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: chunk of %zu elements exceeds BLAS int range\n", fn, chunk);
+        return -1;
+    }
+    return 0;
+}
+
+int vec_stream_stats(struct VecChunkSource src, size_t chunk, struct VecStreamStats *out)
+{
+    if (!src.next || !out) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_stream_stats error: invalid source or output\n");
+        return -1;
+    }
+
+    if (chunk == 0) chunk = STREAM_DEFAULT_CHUNK;
+    if (check_chunk("vec_stream_stats", chunk) != 0) return -1;
+
+    struct Reader r;
+    if (reader_open(&r, src, chunk) != 0) {
+        fprintf(stderr, "vec_stream_stats error: failed to allocate chunk buffers (%s)\n",
+                strerror(errno));
+        return -1;
+    }
+
+    size_t n = 0;
+    double mean = 0.0, m2 = 0.0, sum = 0.0, norm = 0.0;
+    double min_value = DBL_MAX, max_value = -DBL_MAX;
+    int rc = 0;
+
+    for (;;) {
+        struct Fill *f = &r.fill[r.cur];
+
+        if (f->got == VEC_CHUNK_ERROR) {
+            errno = f->err;
+            fprintf(stderr, "vec_stream_stats error: source failed (%s)\n", strerror(errno));
+            rc = -1;
+            break;
+        }
+        if (f->got == 0) break;
+
+        /* a short chunk is the last one */
+        if (f->got == f->cap) reader_prefetch(&r);
+
+        const double *x = f->data;
+        size_t m = f->got;
+
+        /* the chunk is hot in cache after the first loop, so the second
+           loop for its centred sum of squares costs no memory traffic */
+        double s = 0.0;
+        for (size_t i = 0; i < m; i++) {
+            s += x[i];
+            if (x[i] < min_value) min_value = x[i];
+            if (x[i] > max_value) max_value = x[i];
+        }
+
+        double chunk_mean = s / (double)m;
+        double chunk_m2 = 0.0;
+        for (size_t i = 0; i < m; i++) {
+            double d = x[i] - chunk_mean;
+            chunk_m2 += d * d;
+        }
+
+        /* Chan et al. pairwise update of (n, mean, M2) */
+        double delta = chunk_mean - mean;
+        size_t total = n + m;
+        mean += delta * (double)m / (double)total;
+        m2 += chunk_m2 + delta * delta * (double)n * (double)m / (double)total;
+        n = total;
+
+        sum += s;
+        norm = hypot(norm, cblas_dnrm2((int)m, x, 1));
+
+        if (f->got < f->cap) break;
+        reader_advance(&r);
+    }
+
+    reader_close(&r);
+    if (rc != 0) return rc;
+
+    out->count = n;
+    out->sum = sum;
+    out->mean = n ? mean : 0.0;
+    out->var = n ? m2 / (double)n : 0.0;
+    out->min = n ? min_value : 0.0;
+    out->max = n ? max_value : 0.0;
+    out->norm2 = norm;
+
+    return 0;
+}
+
+int vec_stream_dot(struct VecChunkSource a, struct VecChunkSource b, size_t chunk, double *out)
+{
+    if (!a.next || !b.next || !out) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_stream_dot error: invalid source or output\n");
+        return -1;
+    }
+
+    if (chunk == 0) chunk = STREAM_DEFAULT_CHUNK;
+    if (check_chunk("vec_stream_dot", chunk) != 0) return -1;
+
+    struct Reader ra, rb;
+    if (reader_open(&ra, a, chunk) != 0) {
+        fprintf(stderr, "vec_stream_dot error: failed to allocate chunk buffers (%s)\n",
+                strerror(errno));
+        return -1;
+    }
+    if (reader_open(&rb, b, chunk) != 0) {
+        reader_close(&ra);
+        fprintf(stderr, "vec_stream_dot error: failed to allocate chunk buffers (%s)\n",
+                strerror(errno));
+        return -1;
+    }
+
+    double dot = 0.0;
+    int rc = 0;
+
+    for (;;) {
+        struct Fill *fa = &ra.fill[ra.cur];
+        struct Fill *fb = &rb.fill[rb.cur];
+
+        if (fa->got == VEC_CHUNK_ERROR || fb->got == VEC_CHUNK_ERROR) {
+            errno = fa->got == VEC_CHUNK_ERROR ? fa->err : fb->err;
+            fprintf(stderr, "vec_stream_dot error: source failed (%s)\n", strerror(errno));
+            rc = -1;
+            break;
+        }
+
+        if (fa->got != fb->got) {
+            errno = EINVAL;
+            fprintf(stderr, "vec_stream_dot error: sources have different lengths\n");
+            rc = -1;
+            break;
+        }
+        if (fa->got == 0) break;
+
+        int last = fa->got < fa->cap;
+        if (!last) {
+            reader_prefetch(&ra);
+            reader_prefetch(&rb);
+        }
+
+        dot += cblas_ddot((int)fa->got, fa->data, 1, fb->data, 1);
+
+        if (last) break;
+        reader_advance(&ra);
+        reader_advance(&rb);
+    }
+
+    reader_close(&ra);
+    reader_close(&rb);
+    if (rc != 0) return rc;
+
+    *out = dot;
+    return 0;
+}
@@ -0,0 +1,144 @@
+/* sum.c */
+
+#include "libs.h"
+#include "vector.h"
+#include "kernels.h"
+
+/* elements per pairwise leaf, summed with the multi-accumulator kernel */
+#define PAIRWISE_LEAF 256
+
+/* ===========================================
+                Policy
+   =========================================== */
+
+static int sum_mode = VEC_SUM_FAST;
+
+int vec_get_sum_mode(void)
+{
+    return sum_mode;
+}
+
+int vec_set_sum_mode(int mode)
+{
+    if (mode < VEC_SUM_FAST || mode > VEC_SUM_KAHAN) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_set_sum_mode error: unknown mode %d\n", mode);
+        return -1;
+    }
+
+    sum_mode = mode;
+    return 0;
+}
+
+/* ===========================================
+                Accumulator
+   =========================================== */
+
+/* Sum under one mode. The pairwise mode fills fixed-size leaves and keeps
+   one partial per level of a binary counter over them, so the tree stays
+   balanced whatever the leaf count. */
+struct SumAcc{
+    int mode;
+    double sum, comp;
+    double leaf;
+    size_t leaf_n;
+    double part[64];
+    uint64_t levels;
+};
+
+static void acc_init(struct SumAcc *acc, int mode)
+{
+    memset(acc, 0, sizeof *acc);
+    acc->mode = mode;
+}
+
+/* binary-counter carry: equal-sized partials merge as soon as they meet */
+static void push_leaf(struct SumAcc *acc, double s)
+{
+    int level = 0;
+    while (acc->levels & ((uint64_t)1 << level)) {
+        s += acc->part[level];
+        acc->levels &= ~((uint64_t)1 << level);
+        level++;
+    }
+    acc->part[level] = s;
+    acc->levels |= (uint64_t)1 << level;
+}
+
+static void acc_add(struct SumAcc *acc, const double *x, size_t n)
+{
+    const struct VecKernels *k = vec_kernels();
+
+    switch (acc->mode) {
+    case VEC_SUM_PAIRWISE:
+        while (n > 0) {
+            size_t len = PAIRWISE_LEAF - acc->leaf_n;
+            if (len > n) len = n;
+
+            acc->leaf += k->sum(x, len);
+            acc->leaf_n += len;
+            x += len;
+            n -= len;
+
+            if (acc->leaf_n == PAIRWISE_LEAF) {
+                push_leaf(acc, acc->leaf);
+                acc->leaf = 0.0;
+                acc->leaf_n = 0;
+            }
+        }
+        break;
+
+    case VEC_SUM_KAHAN:
+        if (n > 0) vec_neumaier_add(&acc->sum, &acc->comp, k->sum_kahan(x, n));
+        break;
+
+    default:
+        if (n > 0) acc->sum += k->sum(x, n);
+        break;
+    }
+}
+
+static double acc_result(const struct SumAcc *acc)
+{
+    switch (acc->mode) {
+    case VEC_SUM_PAIRWISE: {
+        /* fold the small partials first, the last leaf smallest of all */
+        double s = acc->leaf;
+        for (int level = 0; level < 64; level++)
+            if (acc->levels & ((uint64_t)1 << level)) s += acc->part[level];
+        return s;
+    }
+
+    case VEC_SUM_KAHAN:
+        return isfinite(acc->sum) ? acc->sum + acc->comp : acc->sum;
+
+    default:
+        return acc->sum;
+    }
+}
+
+/* ===========================================
+                Sums
+   =========================================== */
+
+double vec_sum_array(const double *x, size_t n, int mode)
+{
+    struct SumAcc acc;
+
+    acc_init(&acc, mode);
+    acc_add(&acc, x, n);
+    return acc_result(&acc);
+}
+
+double vec_aggr_sum_mode(const struct Vector *vector, int mode)
+{
+    if(!vector || !vector->data || vector->size == 0) return 0.0;
+
+    if (mode < VEC_SUM_FAST || mode > VEC_SUM_KAHAN) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_aggr_sum_mode error: unknown mode %d\n", mode);
+        return NAN;
+    }
+
+    return vec_sum_array(vector->data, vector->size, mode);
+}
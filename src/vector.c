@@ -1,7 +1,22 @@
 /* vector.c */
 
+/* madvise / MADV_HUGEPAGE are hidden by -std=c11 unless asked for */
+#if defined(__linux__) && !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
+
 #include "libs.h"
 #include "vector.h"
+#include "vmath.h"
+#include "kernels.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
 
 /* PIE MACRO */
 
@@ -10,12 +25,148 @@
 #endif
 
 
+/* ===========================================
+                Aligned storage
+   =========================================== */
+
+static int hugepages_enabled = -1;   /* -1: not read from AXPY_HUGEPAGES yet */
+
+void vec_set_hugepages(int enable)
+{
+    hugepages_enabled = enable ? 1 : 0;
+}
+
+int vec_get_hugepages(void)
+{
+    if (hugepages_enabled < 0) {
+        const char *env = getenv("AXPY_HUGEPAGES");
+        hugepages_enabled = (env && env[0] != '\0' && env[0] != '0') ? 1 : 0;
+    }
+    return hugepages_enabled;
+}
+
+size_t vec_alignment(void)
+{
+    return VEC_ALIGNMENT;
+}
+
+int vec_is_aligned(const struct Vector *v)
+{
+    if (!v || !v->data) return 0;
+
+    return ((uintptr_t)v->data % VEC_ALIGNMENT) == 0;
+}
+
+void *vec_aligned_alloc(size_t bytes)
+{
+    size_t alignment = VEC_ALIGNMENT;
+    int huge = 0;
+
+    if (bytes == 0) bytes = 1;
+
+    if (bytes >= VEC_HUGEPAGE_THRESHOLD && vec_get_hugepages()) {
+        alignment = VEC_HUGEPAGE_SIZE;
+        huge = 1;
+    }
+
+    /* aligned_alloc wants the size to be a multiple of the alignment */
+    if (bytes > SIZE_MAX - alignment) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    bytes = (bytes + alignment - 1) & ~(alignment - 1);
+
+#if defined(_WIN32)
+    void *ptr = _aligned_malloc(bytes, alignment);
+#else
+    void *ptr = aligned_alloc(alignment, bytes);
+#endif
+
+    if (!ptr) {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    /* only a hint: the kernel may still fall back to 4 KiB pages */
+    if (huge) madvise(ptr, bytes, MADV_HUGEPAGE);
+#else
+    (void)huge;
+#endif
+
+    return ptr;
+}
+
+void vec_aligned_free(void *ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
 /* ===========================================
                 Vector creation
    =========================================== */
 
+/* vec_alloc hands out single-block vectors up to this many elements */
+static size_t inline_threshold = 0;
+
+void vec_set_inline_threshold(size_t size)
+{
+    inline_threshold = size;
+}
+
+size_t vec_get_inline_threshold(void)
+{
+    return inline_threshold;
+}
+
+struct Vector *vec_alloc_inline(size_t size)
+{
+    if (size > (SIZE_MAX - sizeof(struct VectorInline)) / sizeof(double)) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_alloc_inline error: size overflows the address space (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    struct VectorInline *block =
+        vec_aligned_alloc(sizeof(struct VectorInline) + size * sizeof(double));
+
+    if (!block)
+    {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_alloc_inline error: failed to allocate vector block (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
+    block->vec.size = size;
+    block->vec.data = block->payload;
+    block->vec.storage = VEC_STORAGE_INLINE;
+
+    return &block->vec;
+}
+
 struct Vector *vec_alloc(size_t size)
 {
+    struct VecArena *arena = vec_arena_current();
+    if (arena) return vec_arena_alloc(arena, size);
+
+    if (size <= inline_threshold) return vec_alloc_inline(size);
+
+    if (size > SIZE_MAX / sizeof(double)) {
+        errno = ENOMEM;
+        fprintf(stderr,
+                "vec_alloc error: size overflows the address space (%s)\n",
+                strerror(errno));
+        return NULL;
+    }
+
     struct Vector *v = malloc(sizeof *v);
 
     if (!v)
@@ -28,14 +179,15 @@ struct Vector *vec_alloc(size_t size)
     }
 
     v->size = size;
-    v->data = malloc(size * sizeof(double));
+    v->storage = VEC_STORAGE_HEAP;
+    v->data = vec_aligned_alloc(size * sizeof(double));
 
     if (!v->data)
     {
         errno = ENOMEM;
         fprintf(stderr,
                 "vec_alloc error: failed to allocate data buffer (%s)\n",
-                stderror(errno));
+                strerror(errno));
         free(v);
         return NULL;
     }
@@ -45,29 +197,18 @@ struct Vector *vec_alloc(size_t size)
 
 struct Vector *vec_zeros(size_t size)
 {
-    struct Vector *v = malloc(sizeof *v);
+    struct Vector *v = vec_alloc(size);
 
     if (!v)
     {
         errno = ENOMEM;
         fprintf(stderr,
-                "vec_zeros: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+                "vec_zeros: failed to allocate Vector (%s)\n",
+                strerror(errno));
         return NULL;
     }
 
-    v->size = size;
-    v->data = calloc(size, sizeof(double));
-
-    if (!v->data)
-    {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_zeros: failed to allocate data buffer (%s)\n",
-                stderror(errno));
-        free(v);
-        return NULL;
-    }
+    memset(v->data, 0, size * sizeof(double));
 
     return v;
 }
@@ -255,8 +396,32 @@ void dest_vector(struct Vector *vector)
 {
     if (!vector) return;
 
-    free(vector->data);
-    free(vector);
+    switch (vector->storage) {
+    case VEC_STORAGE_HEAP:
+        vec_aligned_free(vector->data);
+        free(vector);
+        return;
+
+    /* arena vectors go away with vec_arena_reset / vec_arena_destroy */
+    case VEC_STORAGE_ARENA:
+        return;
+
+    case VEC_STORAGE_MMAP:
+        vec_mmap_close(vector);
+        return;
+
+    /* vec is the first member, so this is the start of the block */
+    case VEC_STORAGE_INLINE:
+        vec_aligned_free(vector);
+        return;
+
+    default:
+        /* most likely an uninitialised struct; leaking it is safer than
+           handing a guessed pointer to the wrong allocator */
+        errno = EINVAL;
+        fprintf(stderr, "dest_vector error: unknown storage tag %u\n", vector->storage);
+        return;
+    }
 }
 
 void print_vector(const struct Vector *vector)
@@ -279,13 +444,7 @@ double vec_aggr_sum(const struct Vector *vector)
 {
     if(!vector || !vector->data || vector->size == 0) return 0.0;
 
-    double total_sum = 0.0;
-
-    for(size_t i = 0; i < vector->size; i++){
-        total_sum += vector->data[i];
-    }
-
-    return total_sum;
+    return vec_sum_array(vector->data, vector->size, vec_get_sum_mode());
 }
 
 double vec_aggr_mean(const struct Vector *vector)
@@ -301,15 +460,7 @@ double vec_aggr_min(const struct Vector *vector)
 {
     if(!vector || !vector->data || vector->size == 0) return 0.0;
 
-    double min_value = DBL_MAX;
-
-    for(size_t i = 0; i < vector->size; i++){
-        if(min_value > vector->data[i]){
-            min_value = vector->data[i];
-        }
-    }
-
-    return min_value;
+    return vec_kernels()->min(vector->data, vector->size);
 }
 
 int vec_aggr_argmin(const struct Vector *vector)
@@ -333,14 +484,7 @@ double vec_aggr_max(const struct Vector *vector)
     if(!vector || !vector->data) return 0.0;
     if(vector->size == 0) return 0.0;
 
-    double max_value = -DBL_MAX;
-
-    for(size_t i = 0; i < vector->size; i++){
-        if(max_value < vector->data[i]){
-            max_value = vector->data[i];
-        }
-    }
-    return max_value;
+    return vec_kernels()->max(vector->data, vector->size);
 }
 
 int vec_aggr_argmax(const struct Vector *vector)
@@ -360,1102 +504,604 @@ int vec_aggr_argmax(const struct Vector *vector)
 }
 
 /* ===================================================
-            Vector Math Operations (Out of Place)
+            Argument checks shared by out-of-place
+            and caller-provided output functions
    ===================================================*/
 
-struct Vector *vec_math_pow(const struct Vector *vector, double power)
+/* validates the input of an out-of-place function and allocates its result */
+static struct Vector *alloc_result(const char *fn, const struct Vector *v)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    if (!v || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s: invalid vector pointer (%s)\n", fn, strerror(errno));
+        return NULL;
+    }
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector)
-    {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                strerror(errno));
+    if (v->size == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s: vector size is zero (%s)\n", fn, strerror(errno));
         return NULL;
     }
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = pow(vector->data[i],power);
+    struct Vector *out = vec_alloc(v->size);
+    if (!out) {
+        errno = ENOMEM;
+        fprintf(stderr, "%s: failed to allocate result (%s)\n", fn, strerror(errno));
+        return NULL;
     }
-    return new_vector;
+
+    return out;
 }
 
-struct Vector *vec_math_sqrt(const struct Vector *vector)
+static int check_into_unary(const char *fn, const struct Vector *dst,
+                            const struct Vector *v)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    if (!dst || !v || !dst->data || !v->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return -1;
+    }
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector)
-    {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                strerror(errno));
-        return NULL;
+    if (v->size == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector size is zero\n", fn);
+        return -1;
     }
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = sqrt(vector->data[i]);
+    if (dst->size != v->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (dst %zu, input %zu)\n",
+                fn, dst->size, v->size);
+        return -1;
     }
-    return new_vector;
+
+    return 0;
 }
 
+static int check_into_binary(const char *fn, const struct Vector *dst,
+                             const struct Vector *a, const struct Vector *b)
+{
+    if (!b || !b->data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: vector pointer is NULL\n", fn);
+        return -1;
+    }
 
-struct Vector *vec_math_cbrt(const struct Vector *vector)
+    if (check_into_unary(fn, dst, a) != 0) return -1;
+
+    if (b->size != a->size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (a %zu, b %zu)\n",
+                fn, a->size, b->size);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* ===================================================
+            Vector Math Operations (Out of Place)
+   ===================================================*/
+
+struct Vector *vec_math_pow(const struct Vector *vector, double power)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    struct Vector *new_vector = alloc_result("vec_math_pow", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector)
-    {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_pow_into(new_vector, vector, power) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = cbrt(vector->data[i]);
+struct Vector *vec_math_sqrt(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_sqrt", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_sqrt_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
+        return NULL;
     }
     return new_vector;
 }
 
-struct Vector *vec_math_sin(const struct Vector *vector)
+struct Vector *vec_math_cbrt(const struct Vector *vector)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    struct Vector *new_vector = alloc_result("vec_math_cbrt", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector)
-    {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_cbrt_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = sin(vector->data[i]);
+struct Vector *vec_math_sin(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_sin", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_sin_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
+        return NULL;
     }
     return new_vector;
 }
 
 struct Vector *vec_math_cos(const struct Vector *vector)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    struct Vector *new_vector = alloc_result("vec_math_cos", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_cos_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = cos(vector->data[i]);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_tan(const struct Vector *vector)
 {
-    if(!vector || !vector->data || vector->size == 0) return NULL;
+    struct Vector *new_vector = alloc_result("vec_math_tan", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_tan_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = tan(vector->data[i]);
-    }
     return new_vector;
 }
 
-
 struct Vector *vec_math_asin(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_asin", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_math_asin_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
+struct Vector *vec_math_acos(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_acos", vector);
+    if (!new_vector) return NULL;
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = asin(vector->data[i]);
+    if (vec_math_acos_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
+        return NULL;
     }
     return new_vector;
 }
 
-struct Vector *vec_math_acos(const struct Vector *vector)
+struct Vector *vec_math_atan(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
+    struct Vector *new_vector = alloc_result("vec_math_atan", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_atan_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+struct Vector *vec_math_sinh(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_sinh", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_sinh_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+struct Vector *vec_math_cosh(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_cosh", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_cosh_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
+    return new_vector;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = acos(vector->data[i]);
+struct Vector *vec_math_tanh(const struct Vector *vector)
+{
+    struct Vector *new_vector = alloc_result("vec_math_tanh", vector);
+    if (!new_vector) return NULL;
+
+    if (vec_math_tanh_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
+        return NULL;
     }
     return new_vector;
 }
 
-struct Vector *vec_math_atan(const struct Vector *vector)
+struct Vector *vec_math_loge(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = atan(vector->data[i]);
-    }
-    return new_vector;
-}
-
-struct Vector *vec_math_sinh(const struct Vector *vector)
-{
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = sinh(vector->data[i]);
-    }
-    return new_vector;
-}
-
-struct Vector *vec_math_cosh(const struct Vector *vector)
-{
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = cosh(vector->data[i]);
-    }
-    return new_vector;
-}
-
-
-struct Vector *vec_math_tanh(const struct Vector *vector)
-{
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = tanh(vector->data[i]);
-    }
-    return new_vector;
-}
-
-struct Vector *vec_math_loge(const struct Vector*vector)
-{
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_loge", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_loge_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for (size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = log(vector->data[i]);
-    }
-
     return new_vector;
 }
 
 struct Vector *vec_math_log(const struct Vector *vector, double base)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_log", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_math_log_into(new_vector, vector, base) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-    if(base <= 1.0) return NULL;
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    double log_base = log(base);
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = log(vector->data[i]) / log_base;
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_exp(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_exp", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_exp_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = exp(vector->data[i]);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_floor(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_floor", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_math_floor_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = floor(vector->data[i]);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_ceil(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_ceil", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_math_ceil_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = ceil(vector->data[i]);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_fmod(const struct Vector *vector, double divisor)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-    if(divisor == 0.0) return NULL;
+    struct Vector *new_vector = alloc_result("vec_math_fmod", vector);
+    if (!new_vector) return NULL;
 
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_fmod_into(new_vector, vector, divisor) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = fmod(vector->data[i], divisor);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_trunc(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_trunc", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
+    if (vec_math_trunc_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = trunc(vector->data[i]);
-    }
     return new_vector;
 }
 
 struct Vector *vec_math_round(const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vector = alloc_result("vec_math_round", vector);
+    if (!new_vector) return NULL;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_math_round_into(new_vector, vector) != 0) {
+        dest_vector(new_vector);
         return NULL;
     }
-
-    struct Vector *new_vector = vec_alloc(vector->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        new_vector->data[i] = round(vector->data[i]);
-    }
     return new_vector;
 }
 
 /* ===================================================
-            Vector Math Operations (inplace)
+            Vector Math Operations (caller-provided output)
    ===================================================*/
-int vec_math_pow_inplace(struct Vector *vector, double power)
-{
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = pow(vector->data[i], power);
-    }
+int vec_math_pow_into(struct Vector *dst, const struct Vector *vector, double power)
+{
+    if (check_into_unary("vec_math_pow_into", dst, vector) != 0) return -1;
 
+    vmath_pow(dst->data, vector->data, vector->size, power);
     return 0;
 }
 
-int vec_math_sqrt_inplace(struct Vector *vector)
+int vec_math_sqrt_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = sqrt(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_sqrt_into", dst, vector) != 0) return -1;
 
+    vmath_sqrt(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_cbrt_inplace(struct Vector *vector)
+int vec_math_cbrt_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = cbrt(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_cbrt_into", dst, vector) != 0) return -1;
 
+    vmath_cbrt(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_sin_inplace(struct Vector *vector)
+int vec_math_sin_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = sin(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_sin_into", dst, vector) != 0) return -1;
 
+    vmath_sin(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_cos_inplace(struct Vector *vector)
+int vec_math_cos_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = cos(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_cos_into", dst, vector) != 0) return -1;
 
+    vmath_cos(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_tan_inplace(struct Vector *vector)
+int vec_math_tan_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = tan(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_tan_into", dst, vector) != 0) return -1;
 
+    vmath_tan(dst->data, vector->data, vector->size);
     return 0;
 }
 
-
-int vec_math_asin_inplace(struct Vector *vector)
+int vec_math_asin_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = asin(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_asin_into", dst, vector) != 0) return -1;
 
+    vmath_asin(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_acos_inplace(struct Vector *vector)
+int vec_math_acos_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = acos(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_acos_into", dst, vector) != 0) return -1;
 
+    vmath_acos(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_atan_inplace(struct Vector *vector)
+int vec_math_atan_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = atan(vector->data[i]);
-    }
+    if (check_into_unary("vec_math_atan_into", dst, vector) != 0) return -1;
 
+    vmath_atan(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_sinh_inplace(struct Vector *vector)
+int vec_math_sinh_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_sinh_into", dst, vector) != 0) return -1;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    vmath_sinh(dst->data, vector->data, vector->size);
+    return 0;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = sinh(vector->data[i]);
-    }
+int vec_math_cosh_into(struct Vector *dst, const struct Vector *vector)
+{
+    if (check_into_unary("vec_math_cosh_into", dst, vector) != 0) return -1;
 
+    vmath_cosh(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_cosh_inplace(struct Vector *vector)
+int vec_math_tanh_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_tanh_into", dst, vector) != 0) return -1;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    vmath_tanh(dst->data, vector->data, vector->size);
+    return 0;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = cosh(vector->data[i]);
-    }
+int vec_math_loge_into(struct Vector *dst, const struct Vector *vector)
+{
+    if (check_into_unary("vec_math_loge_into", dst, vector) != 0) return -1;
 
+    vmath_log(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_tanh_inplace(struct Vector *vector)
+int vec_math_log_into(struct Vector *dst, const struct Vector *vector, double base)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_log_into", dst, vector) != 0) return -1;
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = tanh(vector->data[i]);
+    if (base <= 1.0) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_math_log_into error: base must be greater than 1\n");
+        return -1;
     }
 
+    vmath_log_base(dst->data, vector->data, vector->size, base);
     return 0;
 }
 
-int vec_math_loge_inplace(struct Vector *vector)
+int vec_math_exp_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_exp_into", dst, vector) != 0) return -1;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    vmath_exp(dst->data, vector->data, vector->size);
+    return 0;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = log(vector->data[i]);
-    }
+int vec_math_floor_into(struct Vector *dst, const struct Vector *vector)
+{
+    if (check_into_unary("vec_math_floor_into", dst, vector) != 0) return -1;
 
+    vmath_floor(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_log_inplace(struct Vector *vector, double base)
+int vec_math_ceil_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_ceil_into", dst, vector) != 0) return -1;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    vmath_ceil(dst->data, vector->data, vector->size);
+    return 0;
+}
 
-    double log_base = log(base);
+int vec_math_fmod_into(struct Vector *dst, const struct Vector *vector, double divisor)
+{
+    if (check_into_unary("vec_math_fmod_into", dst, vector) != 0) return -1;
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = log(vector->data[i]) / log_base;
+    if (divisor == 0.0) {
+        errno = EDOM;
+        fprintf(stderr, "vec_math_fmod_into error: divisor is zero\n");
+        return -1;
     }
 
+    vmath_fmod(dst->data, vector->data, vector->size, divisor);
     return 0;
 }
 
-int vec_math_exp_inplace(struct Vector *vector)
+int vec_math_trunc_into(struct Vector *dst, const struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    if (check_into_unary("vec_math_trunc_into", dst, vector) != 0) return -1;
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    vmath_trunc(dst->data, vector->data, vector->size);
+    return 0;
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = exp(vector->data[i]);
-    }
+int vec_math_round_into(struct Vector *dst, const struct Vector *vector)
+{
+    if (check_into_unary("vec_math_round_into", dst, vector) != 0) return -1;
 
+    vmath_round(dst->data, vector->data, vector->size);
     return 0;
 }
 
-int vec_math_floor_inplace(struct Vector *vector)
+/* ===================================================
+            Vector Math Operations (inplace)
+   ===================================================*/
+
+/* the kernels read each block before writing it, so dst == vector is safe */
+int vec_math_pow_inplace(struct Vector *vector, double power)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    return vec_math_pow_into(vector, vector, power);
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+int vec_math_sqrt_inplace(struct Vector *vector)
+{
+    return vec_math_sqrt_into(vector, vector);
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = floor(vector->data[i]);
-    }
+int vec_math_cbrt_inplace(struct Vector *vector)
+{
+    return vec_math_cbrt_into(vector, vector);
+}
 
-    return 0;
+int vec_math_sin_inplace(struct Vector *vector)
+{
+    return vec_math_sin_into(vector, vector);
 }
 
-int vec_math_ceil_inplace(struct Vector *vector)
+int vec_math_cos_inplace(struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    return vec_math_cos_into(vector, vector);
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+int vec_math_tan_inplace(struct Vector *vector)
+{
+    return vec_math_tan_into(vector, vector);
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = ceil(vector->data[i]);
-    }
+int vec_math_asin_inplace(struct Vector *vector)
+{
+    return vec_math_asin_into(vector, vector);
+}
 
-    return 0;
+int vec_math_acos_inplace(struct Vector *vector)
+{
+    return vec_math_acos_into(vector, vector);
 }
 
-int vec_math_fmod_inplace(struct Vector *vector, double divisor)
+int vec_math_atan_inplace(struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_fmod_inplace: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    return vec_math_atan_into(vector, vector);
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_fmod_inplace: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-    if(divisor == 0.0) return NULL;
+int vec_math_sinh_inplace(struct Vector *vector)
+{
+    return vec_math_sinh_into(vector, vector);
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = fmod(vector->data[i], divisor);
-    }
+int vec_math_cosh_inplace(struct Vector *vector)
+{
+    return vec_math_cosh_into(vector, vector);
+}
 
-    return 0;
+int vec_math_tanh_inplace(struct Vector *vector)
+{
+    return vec_math_tanh_into(vector, vector);
 }
 
-int vec_math_trunc_inplace(struct Vector *vector)
+int vec_math_loge_inplace(struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_trunc_inplace: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    return vec_math_loge_into(vector, vector);
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_trunc_inplace: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+int vec_math_log_inplace(struct Vector *vector, double base)
+{
+    return vec_math_log_into(vector, vector, base);
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = trunc(vector->data[i]);
-    }
+int vec_math_exp_inplace(struct Vector *vector)
+{
+    return vec_math_exp_into(vector, vector);
+}
 
-    return 0;
+int vec_math_floor_inplace(struct Vector *vector)
+{
+    return vec_math_floor_into(vector, vector);
 }
 
-int vec_math_round_inplace(struct Vector *vector)
+int vec_math_ceil_inplace(struct Vector *vector)
 {
-    if (!vector || !vector->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_round_inplace: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    return vec_math_ceil_into(vector, vector);
+}
 
-    if (vector->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_math_round_inplace: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+int vec_math_fmod_inplace(struct Vector *vector, double divisor)
+{
+    return vec_math_fmod_into(vector, vector, divisor);
+}
 
-    for(size_t i = 0; i < vector->size; i++){
-        vector->data[i] = round(vector->data[i]);
-    }
+int vec_math_trunc_inplace(struct Vector *vector)
+{
+    return vec_math_trunc_into(vector, vector);
+}
 
-    return 0;
+int vec_math_round_inplace(struct Vector *vector)
+{
+    return vec_math_round_into(vector, vector);
 }
 
 
@@ -1463,39 +1109,24 @@ int vec_math_round_inplace(struct Vector *vector)
 
 struct Vector *vec_mul(const struct Vector *a, const struct Vector *b)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector pointer is NULL\n");
-        return NULL;
-    }
+    struct Vector *new_vec = alloc_result("vec_mul", a);
+    if (!new_vec) return NULL;
 
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector data pointer is NULL\n");
+    if (vec_mul_into(new_vec, a, b) != 0) {
+        dest_vector(new_vec);
         return NULL;
     }
 
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector size is zero\n");
-        return NULL;
-    }
-    if(a->size != b->size) return NULL:
+    return new_vec;
+}
 
-    struct Vector *new_vec = vec_alloc(a->size);
-    if(!new_vector){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno));
-        return NULL;
-    }
+int vec_mul_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_mul_into", dst, a, b) != 0) return -1;
 
-    for(size_t i= 0; i < a->size; i++){
-        new_vec->data[i] = a->data[i] * b->data[i];
-    }
+    vec_kernels()->mul(dst->data, a->data, b->data, a->size);
 
-    return new_vec;
+    return 0;
 }
 
 int vec_mul_inplace(struct Vector *a, const struct Vector *b)
@@ -1503,9 +1134,7 @@ int vec_mul_inplace(struct Vector *a, const struct Vector *b)
     if(!a || !b || !a->data || !b->data) return -1;
     if(a->size != b->size) return -1;
 
-    for(size_t i = 0; i < a->size; i++){
-        a->data[i]*=b->size[i];
-    }
+    vec_kernels()->mul(a->data, a->data, b->data, a->size);
 
     return 0;
 
@@ -1525,11 +1154,7 @@ double vec_dot(const struct Vector *a, const struct Vector *b)
         sum += a->data[i] * b->data[i];
     }*/
 
-    return cblas_ddot(
-        (int)a->size,     // number of elements
-        a->data, 1,       // vector a, stride 1
-        b->data, 1        // vector b, stride 1
-    );
+    return vec_view_dot(vec_view(a), vec_view(b));
 }
 
 
@@ -1538,13 +1163,7 @@ int vec_copy(struct Vector *dest, const struct Vector *src)
     if (!dest || !src) return -1;
     if (dest->size != src->size) return -1;
 
-    cblas_dcopy(
-        (int)src->size,   // number of elements
-        src->data, 1,     // source vector, stride 1
-        dest->data, 1     // destination vector, stride 1
-    );
-
-    return 0;
+    return vec_view_copy(vec_view(dest), vec_view(src));
 }
 
 int vec_scale_inplace(struct Vector *v, double scalar)
@@ -1552,13 +1171,7 @@ int vec_scale_inplace(struct Vector *v, double scalar)
     if (!v) return -1;
     if (!v->data) return -1;
 
-    cblas_dscal(
-        (int)v->size,   // number of elements
-        scalar,         // scaling factor
-        v->data, 1      // vector data, stride 1
-    );
-
-    return 0;
+    return vec_view_scale(vec_view(v), scalar);
 }
 
 int vec_axpy_inplace(struct Vector *y, const struct Vector *x, double a)
@@ -1568,14 +1181,7 @@ int vec_axpy_inplace(struct Vector *y, const struct Vector *x, double a)
     if (y->size != x->size) return -1;
     if (!y->data || !x->data) return -1;
 
-    cblas_daxpy(
-        (int)y->size,   // number of elements
-        a,              // scalar multiplier
-        x->data, 1,     // vector x
-        y->data, 1      // vector y (modified in-place)
-    );
-
-    return 0;
+    return vec_view_axpy(vec_view(y), vec_view(x), a);
 }
 
 double vec_norm2(const struct Vector *v)
@@ -1587,10 +1193,7 @@ double vec_norm2(const struct Vector *v)
 
     if (!v || !v->data) return 0.0;
 
-    return cblas_dnrm2(
-        (int)v->size,   // number of elements
-        v->data, 1      // vector data, stride 1
-    );
+    return vec_view_norm2(vec_view(v));
 }
 
 double vec_asum(const struct Vector *v)
@@ -1602,10 +1205,7 @@ double vec_asum(const struct Vector *v)
     }*/
     if (!v || !v->data) return 0.0;
 
-    return cblas_dasum(
-        (int)v->size,
-        v->data, 1
-    );
+    return vec_view_asum(vec_view(v));
 }
 
 int vec_iamax(const struct Vector *v)
@@ -1621,10 +1221,7 @@ int vec_iamax(const struct Vector *v)
     return idx;*/
     if (!v || !v->data) return -1;
 
-    return cblas_idamax(
-        (int)v->size,
-        v->data, 1
-    );
+    return vec_view_iamax(vec_view(v));
 }
 
 /* ====================================================
@@ -1633,247 +1230,145 @@ int vec_iamax(const struct Vector *v)
 
 struct Vector *vec_add(const struct Vector *a, const struct Vector *b)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector pointer is NULL\n");
-        return NULL;
-    }
-
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector data pointer is NULL\n");
-        return NULL;
-    }
-
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_add error: vector size is zero\n");
-        return NULL;
-    }
+    struct Vector *c = alloc_result("vec_add", a);
+    if (!c) return NULL;
 
-    struct Vector *c = vec_alloc(a->size);
-    if(!c){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno)
-        );
+    if (vec_add_into(c, a, b) != 0) {
+        dest_vector(c);
         return NULL;
     }
 
-    /* c = a */
-    cblas_dcopy(
-        (int)a->size,
-        a->data, 1,
-        c->data, 1
-    );
-
-    /* c = c + b */
-    cblas_daxpy(
-        (int)b->size,
-        1.0,
-        b->data, 1,
-        c->data, 1
-    );
-
     return c;
 }
 
 struct Vector *vec_sub(const struct Vector *a, const struct Vector *b)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_sub error: vector pointer is NULL\n");
-        return NULL;
-    }
+    struct Vector *c = alloc_result("vec_sub", a);
+    if (!c) return NULL;
 
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_sub error: vector data pointer is NULL\n");
+    if (vec_sub_into(c, a, b) != 0) {
+        dest_vector(c);
         return NULL;
     }
 
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_sub error: vector size is zero\n");
-        return NULL;
-    }
+    return c;
+}
 
-    struct Vector *c = vec_alloc(a->size);
-    if(!c){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno)
-        );
-        return NULL;
-    }
+int vec_add_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_add_into", dst, a, b) != 0) return -1;
 
-    /* c = a */
-    cblas_dcopy(
-        (int)a->size,
-        a->data, 1,
-        c->data, 1
-    );
+    /* one fused pass instead of dcopy + daxpy, and aliasing needs no care */
+    vec_kernels()->add(dst->data, a->data, b->data, a->size);
+
+    return 0;
+}
+
+int vec_sub_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_sub_into", dst, a, b) != 0) return -1;
 
-    /* c = c - b */
-    cblas_daxpy(
-        (int)b->size,
-        -1.0,
-        b->data, 1,
-        c->data, 1
-    );
+    vec_kernels()->sub(dst->data, a->data, b->data, a->size);
 
-    return c;
+    return 0;
 }
 
 /* Scalar Functions (out of place)*/
 
 struct Vector *vec_add_scalar(const struct Vector *v, double s)
 {
-    if (!v || !v->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_add_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_add_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vec = alloc_result("vec_add_scalar", v);
+    if (!new_vec) return NULL;
 
-    struct Vector *new_vec = vec_alloc(v->size);
-    if(!new_vec){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno)
-        );
+    if (vec_add_scalar_into(new_vec, v, s) != 0) {
+        dest_vector(new_vec);
         return NULL;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        new->data = v->data[i] + s;
-    }
-
     return new_vec;
 }
 
 struct Vector *vec_sub_scalar(const struct Vector *v, double s)
 {
-    if (!v || !v->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_sub_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_sub_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vec = alloc_result("vec_sub_scalar", v);
+    if (!new_vec) return NULL;
 
-    struct Vector *new_vec = vec_alloc(v->size);
-    if(!new_vec){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno)
-        );
+    if (vec_sub_scalar_into(new_vec, v, s) != 0) {
+        dest_vector(new_vec);
         return NULL;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        new->data = v->data[i] - s;
-    }
-
     return new_vec;
 }
 
 struct Vector *vec_mul_scalar(const struct Vector *v, double s)
 {
-    if (!v || !v->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_mul_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_mul_scalar: vector size is zero (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vec = alloc_result("vec_mul_scalar", v);
+    if (!new_vec) return NULL;
 
-    struct Vector *new_vec = vec_alloc(v->size);
-    if(!new_vec){
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: failed to allocate Vector struct (%s)\n",
-                stderror(errno)
-        );
+    if (vec_mul_scalar_into(new_vec, v, s) != 0) {
+        dest_vector(new_vec);
         return NULL;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        new->data = v->data[i] * s;
-    }
-
     return new_vec;
 }
 
 struct Vector *vec_div_scalar(const struct Vector *v, double s)
 {
-    if (!v || !v->data) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: invalid vector pointer (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
+    struct Vector *new_vec = alloc_result("vec_div_scalar", v);
+    if (!new_vec) return NULL;
 
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr,
-                "vec_div_scalar: vector size is zero (%s)\n",
-                strerror(errno));
+    if (vec_div_scalar_into(new_vec, v, s) != 0) {
+        dest_vector(new_vec);
         return NULL;
     }
 
+    return new_vec;
+}
+
+/* Scalar Functions (caller-provided output) */
+
+int vec_add_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_add_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->add_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
+}
+
+int vec_sub_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_sub_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->sub_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
+}
+
+int vec_mul_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_mul_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->mul_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
+}
+
+int vec_div_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_div_scalar_into", dst, v) != 0) return -1;
+
     if (s == 0.0) {
         errno = ERANGE;
-        fprintf(stderr,
-                "vec_div_scalar: division by zero scalar (%s)\n",
-                strerror(errno));
-        return NULL;
-    }
-
-    struct Vector *new_vec = vec_alloc(v->size);
-    if (!new_vec) {
-        errno = ENOMEM;
-        fprintf(stderr,
-                "vec_alloc: allocation failed (%s)\n",
-                strerror(errno));
-        return NULL;
+        fprintf(stderr, "vec_div_scalar_into error: division by zero scalar\n");
+        return -1;
     }
 
-    for (size_t i = 0; i < v->size; ++i){
-        new_vec->data[i] = v->data[i] / s;
-    }
+    vec_kernels()->div_scalar(dst->data, v->data, s, v->size);
 
-    return new_vec;
+    return 0;
 }
 
 /* Scalar Functions (inplace) */
@@ -1897,9 +1392,7 @@ int vec_add_scalar_inplace(struct Vector *v, double s)
         return -1;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        v->data[i]+=s;
-    }
+    vec_kernels()->add_scalar(v->data, v->data, s, v->size);
 
     return 0;
 }
@@ -1924,9 +1417,7 @@ int vec_sub_scalar_inplace(struct Vector *v, double s)
         return -1;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        v->data[i]-=s;
-    }
+    vec_kernels()->sub_scalar(v->data, v->data, s, v->size);
 
     return 0;
 }
@@ -1951,9 +1442,7 @@ int vec_mul_scalar_inplace(struct Vector *v, double s)
         return -1;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        v->data[i]*=s;
-    }
+    vec_kernels()->mul_scalar(v->data, v->data, s, v->size);
 
     return 0;
 }
@@ -1984,9 +1473,7 @@ int vec_div_scalar_inplace(struct Vector *v, double s)
         return -1;
     }
 
-    for(size_t i = 0; i < v->size; i++){
-        v->data[i]/=s;
-    }
+    vec_kernels()->div_scalar(v->data, v->data, s, v->size);
 
     return 0;
 }
@@ -2013,18 +1500,12 @@ double vec_var(const struct Vector *v)
         return -1;
     }
 
-    double mean = 0.0;
-    for (size_t i = 0; i < v->size; ++i)
-        mean += v->data[i];
-    mean /= v->size;
+    struct VecMoments m;
 
-    double var = 0.0;
-    for (size_t i = 0; i < v->size; ++i) {
-        double diff = v->data[i] - mean;
-        var += diff * diff;
-    }
+    vec_moments_init(&m);
+    vec_moments_update(&m, v, NULL);
 
-    return var / v->size;
+    return vec_moments_var(&m);
 }
 
 double vec_std(const struct Vector *v)
@@ -2033,89 +1514,6 @@ double vec_std(const struct Vector *v)
     return sqrt(variance);
 }
 
-double vec_median(const struct Vector *v)
-{
-    if (!v) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_median error: vector pointer is NULL\n");
-        return -1;
-    }
-
-    if (!v->data) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_median error: vector data pointer is NULL\n");
-        return -1;
-    }
-
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_median error: vector size is zero\n");
-        return -1;
-    }
-
-    double *copy = malloc(sizeof(double) * v->size);
-    if (!copy) return -1;
-
-    memcpy(copy, v->data, sizeof(double) * v->size);
-    qsort(copy, v->size, sizeof(double), cmp_double);
-
-    double median;
-    if (v->size % 2 == 0)
-        median = (copy[v->size/2 - 1] + copy[v->size/2]) / 2.0;
-    else
-        median = copy[v->size/2];
-
-    free(copy);
-    return median;
-}
-
-static int cmp_double(const void *a, const void *b)
-{
-    double x = *(const double *)a;
-    double y = *(const double *)b;
-    return (x > y) - (x < y);
-}
-
-double vec_percentile(const struct Vector *v, double p)
-{
-    if (!v) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_percentile error: vector pointer is NULL\n");
-        return -1;
-    }
-
-    if (!v->data) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_percentile error: vector data pointer is NULL\n");
-        return -1;
-    }
-
-    if (v->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_percentile error: vector size is zero\n");
-        return -1;
-    }
-
-    if (p < 0.0 || p > 100.0){
-        errno = ERANGE;
-        fprintf(stderr, "vec_percentile error: p is out of range\n");
-        return -1;
-    }
-
-    double *copy = malloc(sizeof(double) * v->size);
-    if (!copy) return -1;
-
-    memcpy(copy, v->data, sizeof(double) * v->size);
-    qsort(copy, v->size, sizeof(double), cmp_double);
-
-    size_t idx = (size_t)ceil((p / 100.0) * v->size) - 1;
-    if (idx >= v->size) idx = v->size - 1;
-
-    double result = copy[idx];
-    free(copy);
-    return result;
-}
-
 double vec_sum_of_squares(const struct Vector *v)
 {
     if (!v) {
@@ -2136,11 +1534,7 @@ double vec_sum_of_squares(const struct Vector *v)
         return -1;
     }
 
-    double sum = 0.0;
-    for (size_t i = 0; i < v->size; ++i)
-        sum += v->data[i] * v->data[i];
-
-    return sum;
+    return vec_kernels()->sum_sq(v->data, v->size);
 }
 
 double vec_cov(const struct Vector *a, const struct Vector *b)
@@ -2152,7 +1546,7 @@ double vec_cov(const struct Vector *a, const struct Vector *b)
         return -1;
     }
 
-    if (!a->data || !b->size) {
+    if (!a->data || !b->data) {
         errno = EINVAL;
         fprintf(stderr, "vec_cov error: vector data pointer is NULL\n");
         return -1;
@@ -2164,20 +1558,18 @@ double vec_cov(const struct Vector *a, const struct Vector *b)
         return -1;
     }
 
-    size_t n = a->size;
-
-    double mean_a = vec_aggr_mean(a);
-    double mean_b = vec_aggr_mean(b);
-
-    mean_a /= n;
-    mean_b /= n;
+    if (a->size != b->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_cov error: vector sizes differ\n");
+        return -1;
+    }
 
-    double cov = 0.0;
+    struct VecMoments m;
 
-    for (size_t i = 0; i < n; ++i)
-        cov += (a->data[i] - mean_a) * (b->data[i] - mean_b);
+    vec_moments_init(&m);
+    vec_moments_update(&m, a, b);
 
-    return cov / n;
+    return vec_moments_cov(&m);
 }
 
 double vec_corr(const struct Vector *a, const struct Vector *b)
@@ -2188,7 +1580,7 @@ double vec_corr(const struct Vector *a, const struct Vector *b)
         return -1;
     }
 
-    if (!a->data || !b->size) {
+    if (!a->data || !b->data) {
         errno = EINVAL;
         fprintf(stderr, "vec_corr error: vector data pointer is NULL\n");
         return -1;
@@ -2200,138 +1592,148 @@ double vec_corr(const struct Vector *a, const struct Vector *b)
         return -1;
     }
 
-    size_t n = a->size;
+    if (a->size != b->size) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_corr error: vector sizes differ\n");
+        return -1;
+    }
 
-    double mean_a = vec_aggr_mean(a);
-    double mean_b = vec_aggr_mean(b);
+    struct VecMoments m;
 
-    mean_a /= n;
-    mean_b /= n;
+    vec_moments_init(&m);
+    vec_moments_update(&m, a, b);
 
-    double cov = 0.0;
-    double var_a = 0.0;
-    double var_b = 0.0;
+    return vec_moments_corr(&m);
+}
 
-    for (size_t i = 0; i < n; ++i) {
-        double da = a->data[i] - mean_a;
-        double db = b->data[i] - mean_b;
+struct Vector *vec_gt(const struct Vector *a, const struct Vector *b)
+{
+    struct Vector *out = alloc_result("vec_gt", a);
+    if (!out) return NULL;
 
-        cov   += da * db;
-        var_a += da * da;
-        var_b += db * db;
+    if (vec_gt_into(out, a, b) != 0) {
+        dest_vector(out);
+        return NULL;
     }
 
-    if (var_a == 0.0 || var_b == 0.0)
-        return NAN;
-
-    return (cov / n) / (sqrt(var_a / n) * sqrt(var_b / n));
+    return out;
 }
 
-#define EPS 1e-12   /* for floating equality */
-
-struct Vector *vec_gt(const struct Vector *a, const struct Vector *b)
+struct Vector *vec_lt(const struct Vector *a, const struct Vector *b)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_gt error: vector pointer is NULL\n");
-        return NULL;
-    }
+    struct Vector *out = alloc_result("vec_lt", a);
+    if (!out) return NULL;
 
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_gt error: vector data pointer is NULL\n");
+    if (vec_lt_into(out, a, b) != 0) {
+        dest_vector(out);
         return NULL;
     }
 
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_gt error: vector size is zero\n");
-        return NULL;
-    }
+    return out;
+}
 
-    struct Vector *out = vec_alloc(a->size);
-    if (!out){
-        errno = ENOMEM;
-        fprintf(stderr, "vec_alloc error: failed to allocate memory (%s)\n",
-        strerror(errno));
+struct Vector *vec_eq(const struct Vector *a, const struct Vector *b)
+{
+    struct Vector *out = alloc_result("vec_eq", a);
+    if (!out) return NULL;
 
+    if (vec_eq_into(out, a, b) != 0) {
+        dest_vector(out);
         return NULL;
     }
 
-    for (size_t i = 0; i < a->size; ++i)
-        out->data[i] = (a->data[i] > b->data[i]) ? 1.0 : 0.0;
-
     return out;
 }
 
-
-struct Vector *vec_lt(const struct Vector *a, const struct Vector *b)
+struct Vector *vec_gt_scalar(const struct Vector *v, double s)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_lt error: vector pointer is NULL\n");
-        return NULL;
-    }
+    struct Vector *out = alloc_result("vec_gt_scalar", v);
+    if (!out) return NULL;
 
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_lt error: vector data pointer is NULL\n");
+    if (vec_gt_scalar_into(out, v, s) != 0) {
+        dest_vector(out);
         return NULL;
     }
 
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_lt error: vector size is zero\n");
-        return NULL;
-    }
+    return out;
+}
 
-    struct Vector *out = vec_alloc(a->size);
-    if (!out){
-        errno = ENOMEM;
-        fprintf(stderr, "vec_alloc error: failed to allocate memory (%s)\n",
-        strerror(errno));
+struct Vector *vec_lt_scalar(const struct Vector *v, double s)
+{
+    struct Vector *out = alloc_result("vec_lt_scalar", v);
+    if (!out) return NULL;
 
+    if (vec_lt_scalar_into(out, v, s) != 0) {
+        dest_vector(out);
         return NULL;
     }
 
-    for (size_t i = 0; i < a->size; ++i)
-        out->data[i] = (a->data[i] < b->data[i]) ? 1.0 : 0.0;
-
     return out;
 }
 
-struct Vector *vec_eq(const struct Vector *a, const struct Vector *b)
+struct Vector *vec_eq_scalar(const struct Vector *v, double s)
 {
-    if (!a || !b) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_eq error: vector pointer is NULL\n");
-        return NULL;
-    }
+    struct Vector *out = alloc_result("vec_eq_scalar", v);
+    if (!out) return NULL;
 
-    if (!a->data || !b->size) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_eq error: vector data pointer is NULL\n");
+    if (vec_eq_scalar_into(out, v, s) != 0) {
+        dest_vector(out);
         return NULL;
     }
 
-    if (a->size == 0 || b->size == 0) {
-        errno = EINVAL;
-        fprintf(stderr, "vec_eq error: vector size is zero\n");
-        return NULL;
-    }
+    return out;
+}
 
-    struct Vector *out = vec_alloc(a->size);
-    if (!out){
-        errno = ENOMEM;
-        fprintf(stderr, "vec_alloc error: failed to allocate memory (%s)\n",
-        strerror(errno));
+int vec_gt_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_gt_into", dst, a, b) != 0) return -1;
 
-        return NULL;
-    }
+    vec_kernels()->gt(dst->data, a->data, b->data, a->size);
 
-    for (size_t i = 0; i < a->size; ++i)
-        out->data[i] =
-            (fabs(a->data[i] - b->data[i]) < EPS) ? 1.0 : 0.0;
+    return 0;
+}
 
-    return out;
+int vec_lt_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_lt_into", dst, a, b) != 0) return -1;
+
+    vec_kernels()->lt(dst->data, a->data, b->data, a->size);
+
+    return 0;
+}
+
+int vec_eq_into(struct Vector *dst, const struct Vector *a, const struct Vector *b)
+{
+    if (check_into_binary("vec_eq_into", dst, a, b) != 0) return -1;
+
+    vec_kernels()->eq(dst->data, a->data, b->data, a->size);
+
+    return 0;
+}
+
+int vec_gt_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_gt_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->gt_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
+}
+
+int vec_lt_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_lt_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->lt_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
+}
+
+int vec_eq_scalar_into(struct Vector *dst, const struct Vector *v, double s)
+{
+    if (check_into_unary("vec_eq_scalar_into", dst, v) != 0) return -1;
+
+    vec_kernels()->eq_scalar(dst->data, v->data, s, v->size);
+
+    return 0;
 }
@@ -0,0 +1,316 @@
+/* view.c */
+
+#include "libs.h"
+#include "vector.h"
+
+/* ===========================================
+                View construction
+   =========================================== */
+
+static struct VectorView view_invalid(void)
+{
+    struct VectorView view = { NULL, 0, 1 };
+    return view;
+}
+
+struct VectorView vec_view(const struct Vector *v)
+{
+    if (!v || !v->data) return view_invalid();
+
+    /* every view wrapper hands the size to CBLAS as an int */
+    if (v->size > (size_t)INT_MAX) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_view error: size exceeds BLAS int range\n");
+        return view_invalid();
+    }
+
+    struct VectorView view = { v->data, v->size, 1 };
+    return view;
+}
+
+struct VectorView vec_view_strided(double *data, size_t size, size_t stride)
+{
+    if (!data || stride == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_view_strided error: NULL data or zero stride\n");
+        return view_invalid();
+    }
+
+    if (size > (size_t)INT_MAX || stride > (size_t)INT_MAX) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_view_strided error: size or stride exceeds BLAS int range\n");
+        return view_invalid();
+    }
+
+    struct VectorView view = { data, size, stride };
+    return view;
+}
+
+struct VectorView vec_view_slice(const struct Vector *v, size_t start, size_t count, size_t step)
+{
+    if (!v || !v->data || step == 0) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_view_slice error: invalid vector or zero step\n");
+        return view_invalid();
+    }
+
+    /* last element touched is start + (count - 1) * step */
+    if (count > 0 && (start >= v->size || (count - 1) > (v->size - 1 - start) / step)) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_view_slice error: slice runs past the end of the vector\n");
+        return view_invalid();
+    }
+
+    return vec_view_strided(v->data + start, count, step);
+}
+
+struct VectorView vec_view_column(double *matrix, size_t rows, size_t cols, size_t col)
+{
+    if (!matrix || col >= cols) {
+        errno = EINVAL;
+        fprintf(stderr, "vec_view_column error: invalid matrix or column index\n");
+        return view_invalid();
+    }
+
+    /* row-major: consecutive rows of one column are cols doubles apart */
+    return vec_view_strided(matrix + col, rows, cols);
+}
+
+
+/* ===========================================
+                BLAS Level-1 on views
+   =========================================== */
+
+double vec_view_dot(struct VectorView a, struct VectorView b)
+{
+    if (!a.data || !b.data) return 0.0;
+    if (a.size != b.size) return 0.0;
+
+    return cblas_ddot(
+        (int)a.size,
+        a.data, (int)a.stride,
+        b.data, (int)b.stride
+    );
+}
+
+int vec_view_copy(struct VectorView dest, struct VectorView src)
+{
+    if (!dest.data || !src.data) return -1;
+    if (dest.size != src.size) return -1;
+
+    cblas_dcopy(
+        (int)src.size,
+        src.data, (int)src.stride,
+        dest.data, (int)dest.stride
+    );
+
+    return 0;
+}
+
+int vec_view_scale(struct VectorView v, double scalar)
+{
+    if (!v.data) return -1;
+
+    cblas_dscal(
+        (int)v.size,
+        scalar,
+        v.data, (int)v.stride
+    );
+
+    return 0;
+}
+
+int vec_view_axpy(struct VectorView y, struct VectorView x, double a)
+{
+    /* Y[i] = alpha * X[i] + Y[i] */
+    if (!y.data || !x.data) return -1;
+    if (y.size != x.size) return -1;
+
+    cblas_daxpy(
+        (int)y.size,
+        a,
+        x.data, (int)x.stride,
+        y.data, (int)y.stride
+    );
+
+    return 0;
+}
+
+double vec_view_norm2(struct VectorView v)
+{
+    if (!v.data) return 0.0;
+
+    return cblas_dnrm2((int)v.size, v.data, (int)v.stride);
+}
+
+double vec_view_asum(struct VectorView v)
+{
+    if (!v.data) return 0.0;
+
+    return cblas_dasum((int)v.size, v.data, (int)v.stride);
+}
+
+int vec_view_iamax(struct VectorView v)
+{
+    if (!v.data) return -1;
+
+    return (int)cblas_idamax((int)v.size, v.data, (int)v.stride);
+}
+
+
+/* ===========================================
+                Elementwise kernels on views
+   =========================================== */
+
+static int check_view_unary(const char *fn, struct VectorView dst, struct VectorView v)
+{
+    if (!dst.data || !v.data) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: view data pointer is NULL\n", fn);
+        return -1;
+    }
+
+    if (dst.size != v.size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: size mismatch (dst %zu, input %zu)\n",
+                fn, dst.size, v.size);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int check_view_binary(const char *fn, struct VectorView dst,
+                             struct VectorView a, struct VectorView b)
+{
+    if (check_view_unary(fn, dst, a) != 0) return -1;
+
+    if (!b.data || b.size != a.size) {
+        errno = EINVAL;
+        fprintf(stderr, "%s error: invalid or mismatched second operand\n", fn);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* the all-unit-stride case gets its own loop so the compiler can vectorise it */
+#define UNIT(v) ((v).stride == 1)
+
+int vec_view_add(struct VectorView dst, struct VectorView a, struct VectorView b)
+{
+    if (check_view_binary("vec_view_add", dst, a, b) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(a) && UNIT(b)) {
+        for (size_t i = 0; i < a.size; i++)
+            dst.data[i] = a.data[i] + b.data[i];
+        return 0;
+    }
+
+    for (size_t i = 0; i < a.size; i++)
+        dst.data[i * dst.stride] = a.data[i * a.stride] + b.data[i * b.stride];
+
+    return 0;
+}
+
+int vec_view_sub(struct VectorView dst, struct VectorView a, struct VectorView b)
+{
+    if (check_view_binary("vec_view_sub", dst, a, b) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(a) && UNIT(b)) {
+        for (size_t i = 0; i < a.size; i++)
+            dst.data[i] = a.data[i] - b.data[i];
+        return 0;
+    }
+
+    for (size_t i = 0; i < a.size; i++)
+        dst.data[i * dst.stride] = a.data[i * a.stride] - b.data[i * b.stride];
+
+    return 0;
+}
+
+int vec_view_mul(struct VectorView dst, struct VectorView a, struct VectorView b)
+{
+    if (check_view_binary("vec_view_mul", dst, a, b) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(a) && UNIT(b)) {
+        for (size_t i = 0; i < a.size; i++)
+            dst.data[i] = a.data[i] * b.data[i];
+        return 0;
+    }
+
+    for (size_t i = 0; i < a.size; i++)
+        dst.data[i * dst.stride] = a.data[i * a.stride] * b.data[i * b.stride];
+
+    return 0;
+}
+
+int vec_view_add_scalar(struct VectorView dst, struct VectorView v, double s)
+{
+    if (check_view_unary("vec_view_add_scalar", dst, v) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(v)) {
+        for (size_t i = 0; i < v.size; i++)
+            dst.data[i] = v.data[i] + s;
+        return 0;
+    }
+
+    for (size_t i = 0; i < v.size; i++)
+        dst.data[i * dst.stride] = v.data[i * v.stride] + s;
+
+    return 0;
+}
+
+int vec_view_sub_scalar(struct VectorView dst, struct VectorView v, double s)
+{
+    if (check_view_unary("vec_view_sub_scalar", dst, v) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(v)) {
+        for (size_t i = 0; i < v.size; i++)
+            dst.data[i] = v.data[i] - s;
+        return 0;
+    }
+
+    for (size_t i = 0; i < v.size; i++)
+        dst.data[i * dst.stride] = v.data[i * v.stride] - s;
+
+    return 0;
+}
+
+int vec_view_mul_scalar(struct VectorView dst, struct VectorView v, double s)
+{
+    if (check_view_unary("vec_view_mul_scalar", dst, v) != 0) return -1;
+
+    if (UNIT(dst) && UNIT(v)) {
+        for (size_t i = 0; i < v.size; i++)
+            dst.data[i] = v.data[i] * s;
+        return 0;
+    }
+
+    for (size_t i = 0; i < v.size; i++)
+        dst.data[i * dst.stride] = v.data[i * v.stride] * s;
+
+    return 0;
+}
+
+int vec_view_div_scalar(struct VectorView dst, struct VectorView v, double s)
+{
+    if (check_view_unary("vec_view_div_scalar", dst, v) != 0) return -1;
+
+    if (s == 0.0) {
+        errno = ERANGE;
+        fprintf(stderr, "vec_view_div_scalar error: division by zero scalar\n");
+        return -1;
+    }
+
+    if (UNIT(dst) && UNIT(v)) {
+        for (size_t i = 0; i < v.size; i++)
+            dst.data[i] = v.data[i] / s;
+        return 0;
+    }
+
+    for (size_t i = 0; i < v.size; i++)
+        dst.data[i * dst.stride] = v.data[i * v.stride] / s;
+
+    return 0;
+}
@@ -0,0 +1,190 @@
+/* vmath.c */
+
+#include "libs.h"
+#include "vmath.h"
+#include "kernels.h"
+
+/* ===================================================
+            Dispatched kernels
+   ===================================================
+
+   The vectorized kernels are instantiated per dispatch level by
+   vmath_impl.h and reached through vec_kernels(), so they run as wide as
+   the level vec_set_isa / AXPY_ISA selected. */
+
+void vmath_exp(double *y, const double *x, size_t n)
+{
+    vec_kernels()->exp(y, x, n);
+}
+
+void vmath_log(double *y, const double *x, size_t n)
+{
+    vec_kernels()->log(y, x, n);
+}
+
+void vmath_log_base(double *y, const double *x, size_t n, double base)
+{
+    double log_base = log(base);
+
+    vmath_log(y, x, n);
+
+    for (size_t i = 0; i < n; i++)
+        y[i] /= log_base;
+}
+
+void vmath_sin(double *y, const double *x, size_t n)
+{
+    vec_kernels()->sin(y, x, n);
+}
+
+void vmath_cos(double *y, const double *x, size_t n)
+{
+    vec_kernels()->cos(y, x, n);
+}
+
+void vmath_tan(double *y, const double *x, size_t n)
+{
+    vec_kernels()->tan(y, x, n);
+}
+
+void vmath_sinh(double *y, const double *x, size_t n)
+{
+    vec_kernels()->sinh(y, x, n);
+}
+
+void vmath_cosh(double *y, const double *x, size_t n)
+{
+    vec_kernels()->cosh(y, x, n);
+}
+
+void vmath_tanh(double *y, const double *x, size_t n)
+{
+    vec_kernels()->tanh(y, x, n);
+}
+
+/* ===================================================
+            sqrt / pow
+   ===================================================*/
+
+void vmath_sqrt(double *y, const double *x, size_t n)
+{
+    vec_kernels()->sqrt(y, x, n);
+}
+
+/* libm pow for a lane the short forms below hand back; the exponent goes
+   through a volatile so the compiler cannot fold pow(x, 2) back into x * x
+   (or pow(x, -1) into 1 / x), which would lose the errno */
+static double pow_libm(double x, double p)
+{
+    volatile double e = p;
+    return pow(x, e);
+}
+
+/* x^0.5 as the sqrt kernel where it provably matches pow: zero, negative,
+   infinite and NaN lanes differ (pow(-inf, 0.5) is +inf, pow(-0, 0.5) is
+   +0, negatives set EDOM), so those elements go to libm pow and the runs
+   between them to the sqrt kernel */
+static void pow_half(double *y, const double *x, size_t n)
+{
+    const struct VecKernels *k = vec_kernels();
+    size_t i = 0;
+
+    while (i < n) {
+        size_t j = i;
+        while (j < n && x[j] >= DBL_MIN && x[j] <= DBL_MAX) j++;
+
+        if (j > i) k->sqrt(y + i, x + i, j - i);
+        if (j < n) {
+            y[j] = pow_libm(x[j], 0.5);
+            j++;
+        }
+
+        i = j;
+    }
+}
+
+void vmath_pow(double *y, const double *x, size_t n, double p)
+{
+    /* exponents with an exact short form; everything else is libm, since a
+       vector pow within a couple of ULP needs a double-double log. The
+       short forms only keep a lane whose result is a normal number: zeros,
+       infinities, NaNs, overflow and underflow are recomputed with pow so
+       the value and errno (ERANGE, the pole at 0^-1) match libm */
+    if (p == 1.0) {
+        if (y != x) memmove(y, x, n * sizeof *y);
+        return;
+    }
+
+    if (p == 2.0) {
+        for (size_t i = 0; i < n; i++) {
+            double xi = x[i], r = xi * xi;
+            y[i] = isnormal(r) ? r : pow_libm(xi, 2.0);
+        }
+        return;
+    }
+
+    if (p == 0.5) {
+        pow_half(y, x, n);
+        return;
+    }
+
+    if (p == -1.0) {
+        for (size_t i = 0; i < n; i++) {
+            double xi = x[i], r = 1.0 / xi;
+            y[i] = isnormal(r) ? r : pow_libm(xi, -1.0);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++)
+        y[i] = pow(x[i], p);
+}
+
+/* ===================================================
+            libm-backed members of the layer
+   ===================================================*/
+
+void vmath_cbrt(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = cbrt(x[i]);
+}
+
+void vmath_asin(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = asin(x[i]);
+}
+
+void vmath_acos(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = acos(x[i]);
+}
+
+void vmath_atan(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = atan(x[i]);
+}
+
+void vmath_floor(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = floor(x[i]);
+}
+
+void vmath_ceil(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = ceil(x[i]);
+}
+
+void vmath_trunc(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = trunc(x[i]);
+}
+
+void vmath_round(double *y, const double *x, size_t n)
+{
+    for (size_t i = 0; i < n; i++) y[i] = round(x[i]);
+}
+
+void vmath_fmod(double *y, const double *x, size_t n, double divisor)
+{
+    for (size_t i = 0; i < n; i++) y[i] = fmod(x[i], divisor);
+}
@@ -0,0 +1,378 @@
+/* vmath_impl.h */
+
+/* Elementwise math kernels behind vmath.h for one dispatch level, included
+   by kernels_impl.h so every kernels_<isa>.c builds them at its own width.
+   Besides the macros kernels_impl.h documents it uses
+
+     V_SQRT(a)          correctly rounded packed square root
+
+   Kernels work on VW doubles at a time through GCC vector extensions,
+   compiled under KERNEL_TARGET, so SSE2 runs 2 lanes, AVX2 4 and AVX-512 8
+   with the same operations in the same order. A block with any lane
+   outside a kernel's fast domain (NaN, inf, overflow/underflow range,
+   domain errors) is handed to libm element by element, so special values
+   and errno come out exactly as libm produces them. The scalar level, and
+   compilers without vector extensions, call libm throughout. */
+
+#if defined(__GNUC__) && VW > 1
+#define VMATH_SIMD 1
+#endif
+
+/* ===================================================
+            Lane helpers
+   ===================================================*/
+
+#if VMATH_SIMD
+
+typedef double  vd __attribute__((vector_size(VW * sizeof(double))));
+typedef int64_t vi __attribute__((vector_size(VW * sizeof(int64_t))));
+
+/* adding then subtracting 1.5 * 2^52 rounds to the nearest integer and
+   leaves that integer in the low mantissa bits of the intermediate */
+#define SHIFTER 0x1.8p52
+
+static KERNEL_TARGET inline vd vload(const double *p)
+{
+    vd v;
+    memcpy(&v, p, sizeof v);
+    return v;
+}
+
+static KERNEL_TARGET inline void vstore(double *p, vd v)
+{
+    memcpy(p, &v, sizeof v);
+}
+
+static KERNEL_TARGET inline vd splat(double s)
+{
+    vd v;
+    for (int j = 0; j < VW; j++) v[j] = s;
+    return v;
+}
+
+static KERNEL_TARGET inline int all_lanes(vi m)
+{
+    int64_t acc = -1;
+    for (int j = 0; j < VW; j++) acc &= m[j];
+    return acc != 0;
+}
+
+/* lane-wise m ? a : b */
+static KERNEL_TARGET inline vd vselect(vi m, vd a, vd b)
+{
+    return (vd)(((vi)a & m) | ((vi)b & ~m));
+}
+
+static KERNEL_TARGET inline vi in_range(vd x, double lo, double hi)
+{
+    /* false for NaN as well, which is what sends NaN to libm */
+    return (x >= splat(lo)) & (x <= splat(hi));
+}
+
+/* converts small integers held as int64 lanes to double without the
+   packed int64 conversion that only AVX-512DQ has */
+static KERNEL_TARGET inline vd i2d(vi k)
+{
+    vi magic = (vi)splat(SHIFTER);
+    return (vd)(k + magic) - splat(SHIFTER);
+}
+
+/* y[i] = f(x[i]), VW lanes at a time while every lane is in [lo, hi] */
+#define VMATH_KERNEL(name, VF, LIBM, lo, hi)                                    \
+static KERNEL_TARGET void KN(name)(double *y, const double *x, size_t n)        \
+{                                                                               \
+    size_t i = 0;                                                               \
+    for (; i + VW <= n; i += VW) {                                              \
+        vd v = vload(x + i);                                                    \
+        if (!all_lanes(in_range(v, lo, hi))) {                                  \
+            for (size_t j = i; j < i + VW; j++) y[j] = LIBM(x[j]);              \
+            continue;                                                           \
+        }                                                                       \
+        vstore(y + i, VF(v));                                                   \
+    }                                                                           \
+    for (; i < n; i++)                                                          \
+        y[i] = LIBM(x[i]);                                                      \
+}
+
+#else
+
+#define VMATH_KERNEL(name, VF, LIBM, lo, hi)                                    \
+static KERNEL_TARGET void KN(name)(double *y, const double *x, size_t n)        \
+{                                                                               \
+    for (size_t i = 0; i < n; i++)                                              \
+        y[i] = LIBM(x[i]);                                                      \
+}
+
+#endif
+
+/* ===================================================
+            exp
+   ===================================================*/
+
+#define LN2_HI 6.93147180369123816490e-01   /* low 32 bits zero, k * LN2_HI exact */
+#define LN2_LO 1.90821492927058770002e-10
+#define LOG2E  1.44269504088896338700e+00
+
+#if VMATH_SIMD
+
+/* exp(r) for |r| <= ln2 / 2, Taylor to degree 13 (truncation < 2^-57) */
+static KERNEL_TARGET inline vd expm_poly(vd r)
+{
+    vd p = splat(1.0 / 6227020800.0);           /* 1/13! */
+    p = p * r + splat(1.0 / 479001600.0);
+    p = p * r + splat(1.0 / 39916800.0);
+    p = p * r + splat(1.0 / 3628800.0);
+    p = p * r + splat(1.0 / 362880.0);
+    p = p * r + splat(1.0 / 40320.0);
+    p = p * r + splat(1.0 / 5040.0);
+    p = p * r + splat(1.0 / 720.0);
+    p = p * r + splat(1.0 / 120.0);
+    p = p * r + splat(1.0 / 24.0);
+    p = p * r + splat(1.0 / 6.0);
+    p = p * r + splat(0.5);
+
+    /* 1 + (r + r^2 * p) keeps the large terms exact until the last add */
+    return splat(1.0) + (r + r * r * p);
+}
+
+/* valid for |x| <= 708, so 2^k stays a normal number */
+static KERNEL_TARGET inline vd vexp(vd x)
+{
+    vd t = x * splat(LOG2E) + splat(SHIFTER);
+    vd k = t - splat(SHIFTER);
+    vd r = (x - k * splat(LN2_HI)) - k * splat(LN2_LO);
+
+    vi scale = ((vi)t + 1023) << 52;
+    return expm_poly(r) * (vd)scale;
+}
+
+#endif
+
+VMATH_KERNEL(exp, vexp, exp, -708.0, 708.0)
+
+/* ===================================================
+            log
+   ===================================================*/
+
+/* fdlibm __ieee754_log coefficients, |error| < 2^-58.45 on the reduced range */
+#define LG1 6.666666666666735130e-01
+#define LG2 3.999999999940941908e-01
+#define LG3 2.857142874366239149e-01
+#define LG4 2.222219843214978396e-01
+#define LG5 1.818357216161805012e-01
+#define LG6 1.531383769920937332e-01
+#define LG7 1.479819860511658591e-01
+
+#if VMATH_SIMD
+
+/* valid for positive normal finite x */
+static KERNEL_TARGET inline vd vlog(vd x)
+{
+    vi bits = (vi)x;
+    vi e = (bits >> 52) - 1023;
+
+    /* mantissa scaled into [1, 2) */
+    vd m = (vd)((bits & 0x000fffffffffffffLL) | 0x3ff0000000000000LL);
+
+    /* move [sqrt 2, 2) down to [sqrt 2 / 2, 1) so f = m - 1 is centred on 0 */
+    vi big = m > splat(1.4142135623730951);
+    m = vselect(big, m * splat(0.5), m);
+    e = e - big;    /* big lanes are -1 */
+
+    vd k = i2d(e);
+    vd f = m - splat(1.0);
+    vd s = f / (splat(2.0) + f);
+    vd z = s * s;
+    vd w = z * z;
+    vd t1 = w * (splat(LG2) + w * (splat(LG4) + w * splat(LG6)));
+    vd t2 = z * (splat(LG1) + w * (splat(LG3) + w * (splat(LG5) + w * splat(LG7))));
+    vd R = t2 + t1;
+    vd hfsq = splat(0.5) * f * f;
+
+    return k * splat(LN2_HI) - ((hfsq - (s * (hfsq + R) + k * splat(LN2_LO))) - f);
+}
+
+#endif
+
+VMATH_KERNEL(log, vlog, log, DBL_MIN, DBL_MAX)
+
+/* ===================================================
+            sin / cos / tan
+   ===================================================*/
+
+/* pi/2 split into 33-bit pieces (fdlibm), k * PIO2_1 and k * PIO2_2 are
+   exact for |k| < 2^20 */
+#define PIO2_1  1.57079632673412561417e+00
+#define PIO2_2  6.07710050630396597660e-11
+#define PIO2_2T 2.02226624879595063154e-21
+#define INVPIO2 6.36619772367581382433e-01
+
+/* fdlibm __kernel_sin / __kernel_cos coefficients for |r| <= pi/4 */
+#define S1 -1.66666666666666324348e-01
+#define S2  8.33333333332248946124e-03
+#define S3 -1.98412698298579493134e-04
+#define S4  2.75573137070700676789e-06
+#define S5 -2.50507602534068634195e-08
+#define S6  1.58969099521155010221e-10
+
+#define C1  4.16666666666666019037e-02
+#define C2 -1.38888888888741095749e-03
+#define C3  2.48015872894767294178e-05
+#define C4 -2.75573143513906633035e-07
+#define C5  2.08757232129817482790e-09
+#define C6 -1.13596475577881948265e-11
+
+/* fast domain for the trig kernels, well inside |k| < 2^20 */
+#define TRIG_MAX 524288.0
+
+#if VMATH_SIMD
+
+static KERNEL_TARGET inline vd ksin(vd r)
+{
+    vd z = r * r;
+    vd p = splat(S2) + z * (splat(S3) + z * (splat(S4) + z * (splat(S5) + z * splat(S6))));
+    vd s = r + (z * r) * (splat(S1) + z * p);
+
+    /* -0 + +0 rounds to +0, keep the sign of a zero argument */
+    return vselect(r == splat(0.0), r, s);
+}
+
+static KERNEL_TARGET inline vd kcos(vd r)
+{
+    vd z = r * r;
+    vd p = z * (splat(C1) + z * (splat(C2) + z * (splat(C3) + z * (splat(C4) + z * (splat(C5) + z * splat(C6))))));
+    vd hz = splat(0.5) * z;
+    vd w = splat(1.0) - hz;
+
+    /* fdlibm's trick: recover what 1 - hz rounded away */
+    return w + (((splat(1.0) - w) - hz) + z * p);
+}
+
+/* x = k * pi/2 + r with |r| <= pi/4, returns r and the quadrant k mod 4 */
+static KERNEL_TARGET inline vd reduce_pio2(vd x, vi *quadrant)
+{
+    vd t = x * splat(INVPIO2) + splat(SHIFTER);
+    vd k = t - splat(SHIFTER);
+
+    *quadrant = (vi)t & 3;
+    return ((x - k * splat(PIO2_1)) - k * splat(PIO2_2)) - k * splat(PIO2_2T);
+}
+
+static KERNEL_TARGET inline vd vsin(vd x)
+{
+    vi q;
+    vd r = reduce_pio2(x, &q);
+    vd s = ksin(r), c = kcos(r);
+
+    /* quadrant 0..3 -> sin r, cos r, -sin r, -cos r */
+    vd v = vselect((q & 1) != 0, c, s);
+    return vselect((q & 2) != 0, -v, v);
+}
+
+static KERNEL_TARGET inline vd vcos(vd x)
+{
+    vi q;
+    vd r = reduce_pio2(x, &q);
+    vd s = ksin(r), c = kcos(r);
+
+    /* quadrant 0..3 -> cos r, -sin r, -cos r, sin r */
+    vd v = vselect((q & 1) != 0, s, c);
+    vi neg = ((q + 1) & 2) != 0;
+    return vselect(neg, -v, v);
+}
+
+static KERNEL_TARGET inline vd vtan(vd x)
+{
+    vi q;
+    vd r = reduce_pio2(x, &q);
+    vd s = ksin(r), c = kcos(r);
+
+    /* odd quadrants: tan(r + pi/2) = -cos r / sin r */
+    vi odd = (q & 1) != 0;
+    return vselect(odd, -c, s) / vselect(odd, s, c);
+}
+
+#endif
+
+VMATH_KERNEL(sin, vsin, sin, -TRIG_MAX, TRIG_MAX)
+VMATH_KERNEL(cos, vcos, cos, -TRIG_MAX, TRIG_MAX)
+VMATH_KERNEL(tan, vtan, tan, -TRIG_MAX, TRIG_MAX)
+
+/* ===================================================
+            sinh / cosh / tanh
+   ===================================================*/
+
+#if VMATH_SIMD
+
+/* sinh for |x| < 1, odd Taylor series to x^19 (truncation < 2^-60) */
+static KERNEL_TARGET inline vd sinh_small(vd x)
+{
+    vd z = x * x;
+    vd p = splat(1.0 / 121645100408832000.0);   /* 1/19! */
+    p = p * z + splat(1.0 / 355687428096000.0);
+    p = p * z + splat(1.0 / 1307674368000.0);
+    p = p * z + splat(1.0 / 6227020800.0);
+    p = p * z + splat(1.0 / 39916800.0);
+    p = p * z + splat(1.0 / 362880.0);
+    p = p * z + splat(1.0 / 5040.0);
+    p = p * z + splat(1.0 / 120.0);
+    p = p * z + splat(1.0 / 6.0);
+    return x + x * z * p;
+}
+
+static KERNEL_TARGET inline vd vsinh(vd x)
+{
+    vd e = vexp(x);
+    vd big = splat(0.5) * (e - splat(1.0) / e);
+    vi small = (x > splat(-1.0)) & (x < splat(1.0));
+    return vselect(small, sinh_small(x), big);
+}
+
+static KERNEL_TARGET inline vd vcosh(vd x)
+{
+    vd e = vexp(x);
+    return splat(0.5) * (e + splat(1.0) / e);
+}
+
+static KERNEL_TARGET inline vd vtanh(vd x)
+{
+    /* |x| < 0.625: sinh / cosh without cancellation, otherwise
+       1 - 2 / (e^2|x| + 1) with the sign put back */
+    vi neg = x < splat(0.0);
+    vd ax = vselect(neg, -x, x);
+
+    vd e2 = vexp(splat(2.0) * ax);
+    vd big = splat(1.0) - splat(2.0) / (e2 + splat(1.0));
+    big = vselect(neg, -big, big);
+
+    vd ex = vexp(x);
+    vd small = sinh_small(x) / (splat(0.5) * (ex + splat(1.0) / ex));
+
+    return vselect(ax < splat(0.625), small, big);
+}
+
+#endif
+
+VMATH_KERNEL(sinh, vsinh, sinh, -708.0, 708.0)
+VMATH_KERNEL(cosh, vcosh, cosh, -708.0, 708.0)
+
+/* past 22 tanh is +-1 to double precision, libm returns that fast */
+VMATH_KERNEL(tanh, vtanh, tanh, -22.0, 22.0)
+
+/* ===================================================
+            sqrt
+   ===================================================*/
+
+#if VMATH_SIMD
+
+/* correctly rounded in hardware; once the domain check has passed errno
+   cannot be touched, so the packed form is exact */
+static KERNEL_TARGET inline vd vsqrt(vd x)
+{
+    return (vd)V_SQRT((vtype)x);
+}
+
+#endif
+
+/* negative input is a domain error, let libm set EDOM */
+VMATH_KERNEL(sqrt, vsqrt, sqrt, 0.0, INFINITY)